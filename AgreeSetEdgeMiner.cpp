@@ -1,9 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
 #include <boost/log/trivial.hpp>
 #include "AgreeSetEdgeMiner.h"
+#include "BoostUtil.h"
 
 using namespace std;
 
+typedef vector<pair<size_t, size_t>> EdgeList;
+typedef vector<EdgeList> EdgeLists;
+
+/**
+ * keeps edges offered up to limits.maxEdges - either the first ones, or a uniform sample of all of them
+ * samples for different agree sets use different random streams
+ */
+class EdgeSample
+{
+    EdgeList &edges;
+    const EdgeLimits &limits;
+    const uint64_t stream;
+    size_t offered;
+    // for weighted sampling, min-heap of keys of kept edges together with their positions in edges
+    vector<pair<double, size_t>> keys;
+
+    // random bits for current offer
+    uint64_t random() const
+    {
+        return fmix64(limits.sampleSeed ^ fmix64(stream * 0x9e3779b97f4a7c15ULL + offered));
+    }
+    // keeps edges with the largest keys u^(1/weight) for uniform u in (0,1), compared as logarithms (Efraimidis & Spirakis)
+    void addWeighted(size_t v, size_t w)
+    {
+        const double u = ((random() >> 11) + 0.5) / 9007199254740992.0;
+        const double key = log(u) / (double((*limits.rowWeights)[v]) * (*limits.rowWeights)[w]);
+        if ( edges.size() < limits.maxEdges )
+        {
+            keys.push_back(make_pair(key, edges.size()));
+            push_heap(keys.begin(), keys.end(), greater<>());
+            edges.push_back(make_pair(v, w));
+        }
+        else if ( key > keys.front().first )
+        {
+            pop_heap(keys.begin(), keys.end(), greater<>());
+            keys.back().first = key;
+            edges[keys.back().second] = make_pair(v, w);
+            push_heap(keys.begin(), keys.end(), greater<>());
+        }
+    }
+public:
+    EdgeSample(EdgeList &edges, const EdgeLimits &limits, uint64_t stream = 0) : edges(edges), limits(limits), stream(stream), offered(0) {}
+    // true if no further edges will be kept
+    bool full() const
+    {
+        return limits.sampleSeed == 0 && edges.size() >= limits.maxEdges;
+    }
+    void add(size_t v, size_t w)
+    {
+        offered++;
+        if ( limits.sampleSeed != 0 && limits.rowWeights != nullptr )
+            addWeighted(v, w);
+        else if ( edges.size() < limits.maxEdges )
+            edges.push_back(make_pair(v, w));
+        else if ( limits.sampleSeed != 0 )
+        {
+            // replaces a kept edge with probability maxEdges/offered
+            const size_t slot = random() % offered;
+            if ( slot < limits.maxEdges )
+                edges[slot] = make_pair(v, w);
+        }
+    }
+};
+
 std::vector<std::pair<size_t, size_t>> getAgreeSetEdges(const Table &table, const AttributeSet &agreeSet)
+{
+    return getAgreeSetEdges(ColumnTable(table), agreeSet);
+}
+
+std::vector<std::pair<size_t, size_t>> getAgreeSetEdges(const ColumnTable &table, const AttributeSet &agreeSet, const EdgeLimits &limits)
 {
     // hash rows based on values in agreeSet & sort by hash
     struct RowRef
@@ -12,32 +88,265 @@ std::vector<std::pair<size_t, size_t>> getAgreeSetEdges(const Table &table, cons
         size_t hashValue;
         bool operator<(const RowRef &other) const { return hashValue < other.hashValue; }
     };
-    vector<RowRef> rowRefs(table.size());
-    IndexSet columnSet = indexSetOf(agreeSet);
-    for ( size_t i = 0; i < table.size(); i++ )
+    const size_t rows = table.rows();
+    vector<RowRef> rowRefs(rows);
+    vector<uint64_t> hashes;
+    subHashes(table, indexSetOf(agreeSet), hashes);
+    for ( size_t i = 0; i < rows; i++ )
     {
         rowRefs[i].rowID = i;
-        rowRefs[i].hashValue = subHash(table[i], columnSet);
+        rowRefs[i].hashValue = hashes[i];
     }
     stable_sort(rowRefs.begin(), rowRefs.end());
     // identify vertex pairs with matching agree sets
     std::vector<std::pair<size_t, size_t>> result;
-    for ( size_t v = 0; v+1 < table.size(); v++ )
-        for ( size_t w = v+1; w < table.size() && rowRefs[v].hashValue == rowRefs[w].hashValue; w++ )
+    EdgeSample sample(result, limits);
+    for ( size_t v = 0; v+1 < rows && !sample.full(); v++ )
+        for ( size_t w = v+1; w < rows && rowRefs[v].hashValue == rowRefs[w].hashValue; w++ )
         {
             // check that agree set matches
             bool match = true;
-            const Row &rowOfV = table[rowRefs[v].rowID];
-            const Row &rowOfW = table[rowRefs[w].rowID];
-            for ( size_t att = 0; att < rowOfV.size(); att++ )
-                if ( (rowOfV[att] == rowOfW[att]) != agreeSet[att] )
+            for ( size_t att = 0; att < table.columns(); att++ )
+                if ( (table.column(att)[rowRefs[v].rowID] == table.column(att)[rowRefs[w].rowID]) != agreeSet[att] )
                 {
                     match = false;
                     break;
                 }
             if ( match )
                 // stability ensures first vertex < second
-                result.push_back(std::make_pair(rowRefs[v].rowID, rowRefs[w].rowID));
+                sample.add(rowRefs[v].rowID, rowRefs[w].rowID);
         }
     return result;
 }
+
+/**
+ * maps edges of reduced table to original rows, subject to limits
+ * without representatives, the first edges may expand to enough pairs, so fewer need to be found
+ */
+static EdgeList expandEdges(const ReducedTable &reduced, const EdgeList &edges, const EdgeLimits &limits, uint64_t stream)
+{
+    EdgeList result;
+    EdgeSample sample(result, limits, stream);
+    for ( size_t i = 0; i < edges.size() && !sample.full(); i++ )
+    {
+        const vector<size_t> &first = reduced.getOriginalRows(edges[i].first), &second = reduced.getOriginalRows(edges[i].second);
+        const size_t firstCount = limits.representativesOnly ? 1 : first.size(), secondCount = limits.representativesOnly ? 1 : second.size();
+        for ( size_t a = 0; a < firstCount && !sample.full(); a++ )
+            for ( size_t b = 0; b < secondCount && !sample.full(); b++ )
+            {
+                const size_t v = first[a], w = second[b];
+                v < w ? sample.add(v, w) : sample.add(w, v);
+            }
+    }
+    return result;
+}
+
+// number of original rows behind each reduced row
+static vector<size_t> expansionCounts(const ReducedTable &reduced)
+{
+    vector<size_t> counts(reduced.table.size());
+    for ( size_t row = 0; row < counts.size(); row++ )
+        counts[row] = reduced.getOriginalRows(row).size();
+    return counts;
+}
+
+/**
+ * limits to use on reduced table: sampling over original rows weights each reduced edge by the number of pairs it
+ * expands to, so that no more than maxEdges reduced edges are kept; these are then sampled again when expanded
+ */
+static EdgeLimits reducedLimits(const EdgeLimits &limits, const vector<size_t> &counts)
+{
+    EdgeLimits result(limits);
+    if ( !limits.representativesOnly && limits.sampleSeed != 0 )
+        result.rowWeights = &counts;
+    return result;
+}
+
+static EdgeList keyAgreeSetEdges(const ReducedTable &reduced, const EdgeLimits &limits, uint64_t stream)
+{
+    EdgeList result;
+    EdgeSample sample(result, limits, stream);
+    for ( const pair<size_t, size_t> &edge : reduced.getKeyAgreeSetEdges(limits.representativesOnly) )
+        sample.add(edge.first, edge.second);
+    return result;
+}
+
+std::vector<std::pair<size_t, size_t>> getAgreeSetEdges(const ReducedTable &reduced, const AttributeSet &agreeSet, const EdgeLimits &limits)
+{
+    if ( reduced.isKeyAgreeSet(agreeSet) )
+        return keyAgreeSetEdges(reduced, limits, 0);
+    // agree sets that differ on trivial columns have no edges
+    AttributeSet reducedSet = reduced.reduce(agreeSet);
+    if ( reduced.expand(reducedSet) != agreeSet )
+        return std::vector<std::pair<size_t, size_t>>();
+    const vector<size_t> counts = expansionCounts(reduced);
+    return expandEdges(reduced, getAgreeSetEdges(reduced.columnTable, reducedSet, reducedLimits(limits, counts)), limits, 0);
+}
+
+// agree set not restricted to a single one
+static const size_t AnyAgreeSet = SIZE_MAX;
+
+/**
+ * groups rows on common and looks up the agree set of each pair within a group; only pairs whose first agreeing column
+ * is col are considered, and only agree set number "only" is accepted unless AnyAgreeSet is given
+ * stops once the samples of all agree sets starting with col are full
+ * returns false without finding any edges if groups hold more than maxPairs pairs
+ */
+static bool addGroupedEdges(const ColumnTable &table, size_t col, const AttributeSet &common, size_t only, size_t maxPairs,
+                            const unordered_map<AttributeSet, size_t> &index, const vector<size_t> &startingAt, vector<EdgeSample> &samples)
+{
+    const size_t rows = table.rows(), columns = table.columns();
+    vector<uint64_t> hashes;
+    subHashes(table, indexSetOf(common), hashes);
+    // sorting row IDs by hash keeps them in increasing order within groups
+    vector<RowID> order(rows);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&hashes](RowID a, RowID b) { return hashes[a] < hashes[b]; });
+    vector<pair<size_t, size_t>> groups;
+    size_t pairs = 0;
+    for ( size_t start = 0, end; start < rows; start = end )
+    {
+        end = start + 1;
+        while ( end < rows && hashes[order[end]] == hashes[order[start]] )
+            end++;
+        if ( end - start > 1 )
+            groups.push_back(make_pair(start, end));
+        pairs += (end - start) * (end - start - 1) / 2;
+    }
+    if ( pairs > maxPairs )
+        return false;
+    auto allFull = [&]() {
+        if ( only != AnyAgreeSet )
+            return samples[only].full();
+        for ( size_t i : startingAt )
+            if ( !samples[i].full() )
+                return false;
+        return true;
+    };
+    AttributeSet agreeSet(columns);
+    for ( auto [start, end] : groups )
+        for ( size_t i = start; i + 1 < end; i++ )
+        {
+            if ( allFull() )
+                return true;
+            for ( size_t j = i + 1; j < end; j++ )
+            {
+                const RowID v = order[i], w = order[j];
+                // pairs agreeing on an earlier column are found from there
+                bool earlier = false;
+                for ( size_t att = 0; att < col && !earlier; att++ )
+                    earlier = table.column(att)[v] == table.column(att)[w];
+                if ( earlier )
+                    continue;
+                // rows grouped by a hash collision may differ on col; their agree set then belongs to another column
+                if ( table.column(col)[v] != table.column(col)[w] )
+                    continue;
+                for ( size_t att = col; att < columns; att++ )
+                    agreeSet[att] = table.column(att)[v] == table.column(att)[w];
+                auto it = index.find(agreeSet);
+                if ( it != index.end() && (only == AnyAgreeSet || it->second == only) )
+                    samples[it->second].add(v, w);
+            }
+        }
+    return true;
+}
+
+EdgeLists getAllAgreeSetEdges(const ColumnTable &table, const vector<AttributeSet> &agreeSets, unsigned threads, const EdgeLimits &limits)
+{
+    const size_t columns = table.columns(), rows = table.rows();
+    EdgeLists result(agreeSets.size());
+    // each agree set gets its edges from one column only, so threads never share a sample
+    vector<EdgeSample> samples;
+    for ( size_t i = 0; i < agreeSets.size(); i++ )
+        samples.emplace_back(result[i], limits, i);
+    unordered_map<AttributeSet, size_t> index;
+    for ( size_t i = 0; i < agreeSets.size(); i++ )
+        index[agreeSets[i]] = i;
+    // agree sets starting with each column, and their intersection
+    vector<vector<size_t>> startingAt(columns);
+    vector<AttributeSet> common(columns);
+    for ( size_t i = 0; i < agreeSets.size(); i++ )
+    {
+        const size_t first = agreeSets[i].find_first();
+        if ( first == AttributeSet::npos )
+            continue;
+        startingAt[first].push_back(i);
+        if ( common[first].empty() )
+            common[first] = agreeSets[i];
+        else
+            common[first] &= agreeSets[i];
+    }
+    // empty agree set is not contained in any group, so all pairs are checked
+    auto emptyIt = index.find(AttributeSet(columns));
+    if ( emptyIt != index.end() )
+    {
+        EdgeSample &sample = samples[emptyIt->second];
+        for ( size_t v = 0; v + 1 < rows && !sample.full(); v++ )
+            for ( size_t w = v + 1; w < rows; w++ )
+            {
+                bool disjoint = true;
+                for ( size_t att = 0; att < columns && disjoint; att++ )
+                    disjoint = table.column(att)[v] != table.column(att)[w];
+                if ( disjoint )
+                    sample.add(v, w);
+            }
+    }
+    /**
+     * a pair is found from the first column it agrees on, by grouping rows on the intersection of all agree sets
+     * starting with that column; if this leaves too many pairs to compare, rows are grouped for each agree set instead
+     */
+    threads = max(1u, min<unsigned>(threads, columns));
+    auto work = [&](unsigned thread) {
+        for ( size_t col = thread; col < columns; col += threads )
+        {
+            if ( startingAt[col].empty() )
+                continue;
+            const size_t maxPairs = rows * startingAt[col].size();
+            if ( startingAt[col].size() > 1 && addGroupedEdges(table, col, common[col], AnyAgreeSet, maxPairs, index, startingAt[col], samples) )
+                continue;
+            for ( size_t i : startingAt[col] )
+                addGroupedEdges(table, col, agreeSets[i], i, SIZE_MAX, index, startingAt[col], samples);
+        }
+    };
+    vector<std::thread> workers;
+    for ( unsigned thread = 1; thread < threads; thread++ )
+        workers.emplace_back(work, thread);
+    work(0);
+    for ( std::thread &worker : workers )
+        worker.join();
+    for ( EdgeList &edges : result )
+        sort(edges.begin(), edges.end());
+    return result;
+}
+
+EdgeLists getAllAgreeSetEdges(const ReducedTable &reduced, const vector<AttributeSet> &agreeSets, unsigned threads, const EdgeLimits &limits)
+{
+    EdgeLists result(agreeSets.size());
+    // agree sets visible in reduced table, and their positions in agreeSets
+    vector<AttributeSet> reducedSets;
+    vector<size_t> positions;
+    for ( size_t i = 0; i < agreeSets.size(); i++ )
+    {
+        if ( reduced.isKeyAgreeSet(agreeSets[i]) )
+        {
+            result[i] = keyAgreeSetEdges(reduced, limits, i);
+            sort(result[i].begin(), result[i].end());
+            continue;
+        }
+        // agree sets that differ on trivial columns have no edges
+        AttributeSet reducedSet = reduced.reduce(agreeSets[i]);
+        if ( reduced.expand(reducedSet) == agreeSets[i] )
+        {
+            reducedSets.push_back(reducedSet);
+            positions.push_back(i);
+        }
+    }
+    const vector<size_t> counts = expansionCounts(reduced);
+    EdgeLists reducedEdges = getAllAgreeSetEdges(reduced.columnTable, reducedSets, threads, reducedLimits(limits, counts));
+    for ( size_t i = 0; i < positions.size(); i++ )
+    {
+        result[positions[i]] = expandEdges(reduced, reducedEdges[i], limits, positions[i]);
+        sort(result[positions[i]].begin(), result[positions[i]].end());
+    }
+    return result;
+}
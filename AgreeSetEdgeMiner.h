@@ -1,10 +1,44 @@
 #ifndef AGREE_SET_EDGE_MINER_H
 #define AGREE_SET_EDGE_MINER_H
 
+#include <cstdint>
 #include "AgreeSetUtil.h"
+#include "TableReduction.h"
+
+// bounds on the edges returned for each agree set
+struct EdgeLimits
+{
+    // edges kept per agree set; unless sampling, search stops once this many are found
+    size_t maxEdges = SIZE_MAX;
+    // if non-zero, keep a uniform random sample of all edges (reservoir sampling) using this seed
+    uint64_t sampleSeed = 0;
+    /**
+     * for reduced tables, only use the first of the original rows collapsed into each reduced row, and a single pair
+     * for the key agree set - the other pairs have the same labels, so they add nothing for informative selection
+     */
+    bool representativesOnly = false;
+    /**
+     * if set while sampling, edge (v,w) counts as rowWeights[v] * rowWeights[w] edges (weighted reservoir sampling),
+     * so that edges of a reduced table can be sampled in proportion to the number of pairs they expand to
+     */
+    const std::vector<size_t> *rowWeights = nullptr;
+};
 
 // returns all vertex pairs with matching agree set
 // first vertex < second vertex is guaranteed for all pairs
 std::vector<std::pair<size_t, size_t>> getAgreeSetEdges(const Table &table, const AttributeSet &agreeSet);
+// as above, for a column-major table (avoids re-creating it when called repeatedly)
+std::vector<std::pair<size_t, size_t>> getAgreeSetEdges(const ColumnTable &table, const AttributeSet &agreeSet, const EdgeLimits &limits = EdgeLimits());
+// as above, for agree set over original columns and pairs of original rows
+std::vector<std::pair<size_t, size_t>> getAgreeSetEdges(const ReducedTable &reduced, const AttributeSet &agreeSet, const EdgeLimits &limits = EdgeLimits());
+
+/**
+ * edges for all agree sets at once, in one grouping pass: result[i] holds the pairs with agree set agreeSets[i],
+ * sorted, with first vertex < second vertex; work is split by column between the given number of threads
+ */
+std::vector<std::vector<std::pair<size_t, size_t>>> getAllAgreeSetEdges(const ColumnTable &table, const std::vector<AttributeSet> &agreeSets,
+                                                                         unsigned threads = 1, const EdgeLimits &limits = EdgeLimits());
+std::vector<std::vector<std::pair<size_t, size_t>>> getAllAgreeSetEdges(const ReducedTable &reduced, const std::vector<AttributeSet> &agreeSets,
+                                                                         unsigned threads = 1, const EdgeLimits &limits = EdgeLimits());
 
 #endif
@@ -1,16 +1,24 @@
 #include <boost/functional/hash.hpp>
-#include <boost/tokenizer.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/expressions.hpp>
+#include <boost/program_options.hpp>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "CSVUtil.h"
 #include "AgreeSetMiner.h"
 #include "AgreeSetEdgeMiner.h"
 #include "VectorUtil.h"
 #include "BoostUtil.h"
+#include "EdgeFile.h"
 
 using namespace std;
+namespace po = boost::program_options;
 
 class LabeledEdge
 {
@@ -26,24 +34,249 @@ public:
     LabeledEdge(size_t v, size_t w, size_t label) : v(v), w(w), label(label) {}
 };
 
+// binary edge files store 32-bit node and label IDs, so IDs 0..count-1 must fit
+static bool fitsEdgeFile(size_t count, const string &what)
+{
+    if ( count <= size_t(numeric_limits<NodeID>::max()) + 1 )
+        return true;
+    cerr << "too many " << what << " for binary edge file: " << count << "\n";
+    return false;
+}
+
+// hands generators from mining thread to edge extraction, in the order they are found
+class GeneratorQueue
+{
+    mutex m;
+    condition_variable changed;
+    deque<AttributeSet> queue;
+    bool closed = false;
+public:
+    void push(const AttributeSet &gen)
+    {
+        lock_guard<mutex> lock(m);
+        queue.push_back(gen);
+        changed.notify_one();
+    }
+    // no more generators will be pushed
+    void close()
+    {
+        lock_guard<mutex> lock(m);
+        closed = true;
+        changed.notify_one();
+    }
+    // waits for next generator, returns false once queue is closed and empty
+    bool pop(AttributeSet &gen)
+    {
+        unique_lock<mutex> lock(m);
+        changed.wait(lock, [this]() { return closed || !queue.empty(); });
+        if ( queue.empty() )
+            return false;
+        gen = std::move(queue.front());
+        queue.pop_front();
+        return true;
+    }
+};
+
 int main(int argc, char *argv[])
 {
-    boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::warning );
-    // read table from stdin
+    string input = "-";
+    string edgeFile;
+    bool reduce = true, debug = false, columnFile = false, stream = false, delta = false;
+    MinerOptions options;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    EdgeLimits limits;
+    // extract command-line arguments
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "show options (this)")
+            ("debug,d", "print debug information")
+            ("input,i", po::value<string>(), "CSV file to read (default: stdin)")
+            ("columns", "input is a column file written by columnizer, which is memory-mapped (implies closure engine, no reduction)")
+            ("no-reduce", "keep duplicate rows and constant/unique columns while mining")
+            ("engine,e", po::value<string>(), "mining engine: auto (default), closure or pairs")
+            ("sample,s", po::value<size_t>(), "seed mining with agree sets of rows up to arg apart in sorted column clusters")
+            ("transversals,t", po::value<string>(), "transversal enumeration for closure engine: berge (default) or mmcs")
+            ("shared", "share generators found between searches for different rhs (closure engine)")
+            ("threads,j", po::value<unsigned>(), "threads used for finding edges (default: number of cores)")
+            ("max-edges,m", po::value<size_t>(), "keep at most arg edges per generator (the first ones found unless sampling)")
+            ("reservoir", po::value<uint64_t>(), "with --max-edges, keep a uniform sample of edges, using arg as non-zero random seed")
+            ("representatives", "use only one of several rows that differ on constant/unique columns only, and one pair for their agree set")
+            ("binary,b", po::value<string>(), "write edges to binary edge file instead of stdout (for informative -b)")
+            ("delta", "delta-encode binary edge file (not with --stream)")
+            ("stream", "print edges of each generator as soon as it is found, unsorted and labeled in order found")
+        ;
+        po::positional_options_description pos;
+        pos.add("input", 1);
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+        po::notify(vm);
+
+        if ( vm.count("help") )
+        {
+            cout << desc << endl;
+            return 0;
+        }
+        if ( vm.count("input") )
+            input = vm["input"].as<string>();
+        if ( vm.count("debug") )
+            debug = true;
+        if ( vm.count("no-reduce") )
+            reduce = false;
+        if ( vm.count("columns") )
+            columnFile = true;
+        if ( vm.count("engine") )
+        {
+            const string engine = vm["engine"].as<string>();
+            if ( engine == "closure" )
+                options.engine = MinerOptions::Engine::Closure;
+            else if ( engine == "pairs" )
+                options.engine = MinerOptions::Engine::Pairs;
+            else if ( engine != "auto" )
+                throw po::error("unknown engine " + engine);
+        }
+        if ( vm.count("sample") )
+            options.sampleWindow = vm["sample"].as<size_t>();
+        if ( vm.count("shared") )
+            options.sharedTraversal = true;
+        if ( vm.count("stream") )
+            stream = true;
+        if ( vm.count("threads") )
+            threads = vm["threads"].as<unsigned>();
+        if ( vm.count("binary") )
+            edgeFile = vm["binary"].as<string>();
+        if ( vm.count("delta") )
+        {
+            if ( edgeFile.empty() || vm.count("stream") )
+                throw po::error("--delta requires --binary and sorted output");
+            delta = true;
+        }
+        if ( vm.count("max-edges") )
+            limits.maxEdges = vm["max-edges"].as<size_t>();
+        if ( vm.count("reservoir") )
+        {
+            limits.sampleSeed = vm["reservoir"].as<uint64_t>();
+            if ( limits.sampleSeed == 0 || !vm.count("max-edges") )
+                throw po::error("--reservoir needs a non-zero seed and --max-edges");
+        }
+        if ( vm.count("representatives") )
+        {
+            if ( !reduce || columnFile )
+                throw po::error("--representatives requires table reduction");
+            limits.representativesOnly = true;
+        }
+        if ( vm.count("transversals") )
+        {
+            const string transversals = vm["transversals"].as<string>();
+            if ( transversals == "mmcs" )
+                options.transversals = MinerOptions::Transversals::MMCS;
+            else if ( transversals != "berge" )
+                throw po::error("unknown transversal algorithm " + transversals);
+        }
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+
+    if ( debug )
+        boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::info );
+    else
+        boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::warning );
+    // column files are mined in place, without loading them into memory
+    ColumnTable columns;
     Table table;
-    read_csv(table, cin);
+    try {
+        if ( columnFile )
+            columns = ColumnTable::map(input);
+        else
+            read_csv(table, input);
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
     BOOST_LOG_TRIVIAL(debug) << "table = " << table << endl;
-    // find generating agree-sets
-    ClosureCalculator closure(table);
-    vector<AttributeSet> generators = getGenerators(closure);
+    unique_ptr<ReducedTable> reduced;
+    if ( !columnFile )
+    {
+        if ( reduce )
+            reduced.reset(new ReducedTable(table));
+        else
+            columns = ColumnTable(table);
+    }
+    // find generating agree-sets, and corresponding agree-set edges
+    auto mine = [&](const GeneratorSink &sink) {
+        if ( reduced )
+            visitGenerators(*reduced, options, sink);
+        else if ( columnFile )
+            visitGenerators(columns, options, sink);
+        else
+            visitGenerators(table, options, sink);
+    };
+    auto edgesOf = [&](const AttributeSet &gen) {
+        return reduced ? getAgreeSetEdges(*reduced, gen, limits) : getAgreeSetEdges(columns, gen, limits);
+    };
+    // edges go to binary file if given, to stdout otherwise
+    unique_ptr<EdgeFileWriter> writer;
+    if ( !edgeFile.empty() && !fitsEdgeFile(columnFile ? columns.rows() : table.size(), "rows") )
+        return 1;
+    try {
+        if ( !edgeFile.empty() )
+            writer.reset(new EdgeFileWriter(edgeFile, delta));
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+    auto printEdge = [&writer](size_t v, size_t w, size_t label) {
+        if ( writer )
+            writer->add(v, w, label);
+        else
+            cout << v << ' ' << w << ' ' << label << '\n';
+    };
+    auto finish = [&writer]() {
+        try {
+            if ( writer )
+                writer->close();
+        } catch(exception& e) {
+            cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    };
+    if ( stream )
+    {
+        // edges of each generator are printed while mining continues in another thread; labels follow discovery order
+        GeneratorQueue queue;
+        thread miner([&]() {
+            mine([&queue](const AttributeSet &gen) { queue.push(gen); });
+            queue.close();
+        });
+        AttributeSet gen;
+        bool tooMany = false;
+        for ( size_t genID = 0; queue.pop(gen); genID++ )
+        {
+            // generators are only counted as they arrive; once IDs overflow, drain the queue so that mining can finish
+            tooMany = tooMany || (writer && !fitsEdgeFile(genID + 1, "generators"));
+            if ( !tooMany )
+                for ( std::pair<size_t, size_t> &edge : edgesOf(gen) )
+                    printEdge(edge.first, edge.second, genID);
+        }
+        miner.join();
+        return tooMany ? 1 : finish();
+    }
+    vector<AttributeSet> generators;
+    mine([&generators](const AttributeSet &gen) { generators.push_back(gen); });
     sort(generators.begin(), generators.end());
-    // find corresponding agree-set edges
+    if ( writer && !fitsEdgeFile(generators.size(), "generators") )
+        return 1;
+    // edges of all generators are found in one pass
+    vector<vector<std::pair<size_t, size_t>>> genEdges = reduced ? getAllAgreeSetEdges(*reduced, generators, threads, limits)
+                                                                 : getAllAgreeSetEdges(columns, generators, threads, limits);
     vector<LabeledEdge> edges;
     for ( size_t genID = 0; genID < generators.size(); genID++ )
-        for ( std::pair<size_t, size_t> &edge : getAgreeSetEdges(table, generators[genID]) )
+        for ( std::pair<size_t, size_t> &edge : genEdges[genID] )
             edges.push_back(LabeledEdge(edge.first, edge.second, genID));
     sort(edges.begin(), edges.end());
-    // print to stdout
     for ( LabeledEdge &e : edges )
-        cout << e.v << ' ' << e.w << ' ' << e.label << endl;
+        printEdge(e.v, e.w, e.label);
+    return finish();
 }
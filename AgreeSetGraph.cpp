@@ -357,10 +357,10 @@ public:
     ~ProgressCounter() { reset(); }
 };
 
-AgreeSetGraph findMinAgreeSetGraph(const vector<AttributeSet> &agreeSets, unsigned int btLimit)
+AgreeSetGraph findMinAgreeSetGraph(const vector<AttributeSet> &agreeSets, unsigned int btLimit, bool isGenerators)
 {
     // reduce to generators
-    const vector<AttributeSet> generators = GenClosureOp::getGenerators(agreeSets);
+    const vector<AttributeSet> generators = isGenerators ? agreeSets : GenClosureOp::getGenerators(agreeSets);
     BOOST_LOG_TRIVIAL(debug) << "agreeSets = " << str(agreeSets);
     BOOST_LOG_TRIVIAL(debug) << "generators = " << str(generators);
     const GenClosureOp closure(generators);
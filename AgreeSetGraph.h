@@ -90,6 +90,7 @@ public:
 };
 
 // main function, btLimit imposes limit on number of back-tracking steps
-AgreeSetGraph findMinAgreeSetGraph(const std::vector<AttributeSet> &agreeSets, unsigned int btLimit = UINT_MAX);
+// isGenerators skips reduction of agreeSets to generators, e.g. for miner output
+AgreeSetGraph findMinAgreeSetGraph(const std::vector<AttributeSet> &agreeSets, unsigned int btLimit = UINT_MAX, bool isGenerators = false);
 
 #endif
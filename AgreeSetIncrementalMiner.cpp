@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <boost/log/trivial.hpp>
+
+#include "AgreeSetIncrementalMiner.h"
+#include "AgreeSetMiner.h"
+#include "BoostUtil.h"
+
+using namespace std;
+
+// file starts with magic string, followed by version
+static const char StateMagic[8] = { 'A', 'S', 'M', 'S', 'T', 'A', 'T', 'E' };
+static const uint64_t StateVersion = 2;
+
+static void write64(ofstream &out, uint64_t value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static uint64_t read64(ifstream &in)
+{
+    uint64_t value;
+    if ( !in.read(reinterpret_cast<char*>(&value), sizeof(value)) )
+        throw runtime_error("unexpected end of state file");
+    return value;
+}
+
+static void writeSet(ofstream &out, const AttributeSet &set)
+{
+    vector<AttributeSet::block_type> blocks;
+    boost::to_block_range(set, back_inserter(blocks));
+    for ( AttributeSet::block_type block : blocks )
+        write64(out, block);
+}
+
+static AttributeSet readSet(ifstream &in, size_t columns)
+{
+    static_assert(sizeof(AttributeSet::block_type) == sizeof(uint64_t), "state file stores 64-bit blocks");
+    vector<AttributeSet::block_type> blocks((columns + AttributeSet::bits_per_block - 1) / AttributeSet::bits_per_block);
+    for ( AttributeSet::block_type &block : blocks )
+        block = read64(in);
+    AttributeSet set(columns);
+    boost::from_block_range(blocks.begin(), blocks.end(), set);
+    return set;
+}
+
+//----------------- MinerState (files) --------------------
+
+MinerState::MinerState(const string &fileName, bool create) : fileName(fileName), columnCount(0), rowCount(0),
+    generation(0), dataSize(0), garbage(0), fd(-1), mapped(nullptr), mappedSize(0)
+{
+    if ( !create )
+    {
+        ifstream in(fileName, ios::binary);
+        if ( !in )
+            throw runtime_error("cannot open " + fileName);
+        char magic[sizeof(StateMagic)];
+        if ( !in.read(magic, sizeof(magic)) || memcmp(magic, StateMagic, sizeof(magic)) != 0 || read64(in) != StateVersion )
+            throw runtime_error(fileName + " is not a miner state file");
+        columnCount = read64(in);
+        rowCount = read64(in);
+        generation = read64(in);
+        dataSize = read64(in);
+        garbage = read64(in);
+        firstRow.resize(columnCount);
+        for ( size_t &value : firstRow )
+            value = read64(in);
+        constant = readSet(in, columnCount);
+        blocks.resize(read64(in));
+        for ( Block &block : blocks )
+            block = Block{ read64(in), read64(in) };
+        runs.resize(read64(in));
+        for ( Run &run : runs )
+            run = Run{ read64(in), read64(in) };
+        const size_t genCount = read64(in);
+        for ( size_t i = 0; i < genCount; i++ )
+            generators.push_back(readSet(in, columnCount));
+    }
+    const string dataName = dataFileName(generation);
+    fd = open(dataName.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+    if ( fd < 0 )
+        throw runtime_error("cannot open " + dataName + ": " + strerror(errno));
+    // drop anything written by an update that failed before saving its state
+    if ( ftruncate(fd, dataSize) != 0 )
+        throw runtime_error("cannot write " + dataName + ": " + strerror(errno));
+    map();
+}
+
+string MinerState::dataFileName(uint64_t gen) const
+{
+    return fileName + "." + to_string(gen);
+}
+
+void MinerState::map()
+{
+    if ( mapped )
+        munmap(mapped, mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+    if ( dataSize == 0 )
+        return;
+    void *data = mmap(nullptr, dataSize, PROT_READ, MAP_SHARED, fd, 0);
+    if ( data == MAP_FAILED )
+        throw runtime_error("cannot map " + dataFileName(generation) + ": " + strerror(errno));
+    mapped = data;
+    mappedSize = dataSize;
+}
+
+const size_t* MinerState::row(RowID row) const
+{
+    auto block = upper_bound(blocks.begin(), blocks.end(), row, [](RowID r, const Block &b) { return r < b.first; }) - 1;
+    return reinterpret_cast<const size_t*>(static_cast<const char*>(mapped) + block->offset) + (row - block->first) * columnCount;
+}
+
+const MinerState::IndexEntry* MinerState::column(const Run &run, size_t col) const
+{
+    return reinterpret_cast<const IndexEntry*>(static_cast<const char*>(mapped) + run.offset) + col * run.rows;
+}
+
+uint64_t MinerState::appendData(const void *data, size_t bytes)
+{
+    const uint64_t offset = dataSize;
+    if ( pwrite(fd, data, bytes, offset) != ssize_t(bytes) )
+        throw runtime_error("cannot write " + dataFileName(generation) + ": " + strerror(errno));
+    dataSize += bytes;
+    return offset;
+}
+
+void MinerState::store(const Table &newRows)
+{
+    if ( newRows.empty() )
+        return;
+    if ( rowCount == 0 )
+    {
+        columnCount = newRows[0].size();
+        firstRow = newRows[0];
+        constant = AttributeSet(columnCount);
+        constant.set();
+    }
+    for ( const Row &r : newRows )
+        if ( r.size() != columnCount )
+            throw runtime_error("expected " + to_string(columnCount) + " columns, found " + to_string(r.size()));
+    for ( const Row &r : newRows )
+        for ( size_t col = constant.find_first(); col != AttributeSet::npos; col = constant.find_next(col) )
+            if ( r[col] != firstRow[col] )
+                constant.reset(col);
+    // rows
+    vector<size_t> cells;
+    cells.reserve(newRows.size() * columnCount);
+    for ( const Row &r : newRows )
+        cells.insert(cells.end(), r.begin(), r.end());
+    blocks.push_back(Block{ appendData(cells.data(), cells.size() * sizeof(size_t)), rowCount });
+    // index run for new rows, merged with preceding runs that are no larger
+    auto byValue = [](const IndexEntry &a, const IndexEntry &b) { return a.value < b.value || (a.value == b.value && a.row < b.row); };
+    uint64_t n = newRows.size();
+    vector<IndexEntry> entries(n * columnCount);
+    for ( size_t col = 0; col < columnCount; col++ )
+    {
+        for ( size_t i = 0; i < n; i++ )
+            entries[col * n + i] = IndexEntry{ newRows[i][col], rowCount + i };
+        sort(entries.begin() + col * n, entries.begin() + (col + 1) * n, byValue);
+    }
+    while ( !runs.empty() && runs.back().rows <= n )
+    {
+        const Run &last = runs.back();
+        vector<IndexEntry> merged((n + last.rows) * columnCount);
+        for ( size_t col = 0; col < columnCount; col++ )
+            std::merge(entries.begin() + col * n, entries.begin() + (col + 1) * n, column(last, col), column(last, col) + last.rows,
+                       merged.begin() + col * (n + last.rows), byValue);
+        garbage += last.rows * columnCount * sizeof(IndexEntry);
+        n += last.rows;
+        entries.swap(merged);
+        runs.pop_back();
+    }
+    runs.push_back(Run{ appendData(entries.data(), entries.size() * sizeof(IndexEntry)), n });
+    rowCount += newRows.size();
+    if ( garbage > dataSize - garbage )
+        compact();
+    else
+        map();
+}
+
+void MinerState::compact()
+{
+    map();
+    const string newName = dataFileName(generation + 1);
+    const int newFd = open(newName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ( newFd < 0 )
+        throw runtime_error("cannot create " + newName + ": " + strerror(errno));
+    uint64_t newSize = 0;
+    auto copy = [&](uint64_t offset, uint64_t bytes) {
+        if ( pwrite(newFd, static_cast<const char*>(mapped) + offset, bytes, newSize) != ssize_t(bytes) )
+        {
+            ::close(newFd);
+            throw runtime_error("cannot write " + newName + ": " + strerror(errno));
+        }
+        newSize += bytes;
+        return newSize - bytes;
+    };
+    // all rows go into a single block
+    vector<Block> newBlocks;
+    for ( size_t i = 0; i < blocks.size(); i++ )
+    {
+        const uint64_t end = i + 1 < blocks.size() ? blocks[i + 1].first : rowCount;
+        const uint64_t offset = copy(blocks[i].offset, (end - blocks[i].first) * columnCount * sizeof(size_t));
+        if ( i == 0 )
+            newBlocks.push_back(Block{ offset, 0 });
+    }
+    vector<Run> newRuns;
+    for ( const Run &run : runs )
+        newRuns.push_back(Run{ copy(run.offset, run.rows * columnCount * sizeof(IndexEntry)), run.rows });
+    BOOST_LOG_TRIVIAL(info) << "compacted " << dataFileName(generation) << " from " << dataSize << " to " << newSize << " bytes";
+    ::close(fd);
+    fd = newFd;
+    obsolete = dataFileName(generation++);
+    dataSize = newSize;
+    garbage = 0;
+    blocks.swap(newBlocks);
+    runs.swap(newRuns);
+    map();
+}
+
+void MinerState::save()
+{
+    if ( fsync(fd) != 0 )
+        throw runtime_error("cannot write " + dataFileName(generation) + ": " + strerror(errno));
+    // write to temporary file first, so that a failed update leaves the old state intact
+    const string tmpName = fileName + ".tmp";
+    ofstream out(tmpName, ios::binary | ios::trunc);
+    if ( !out )
+        throw runtime_error("cannot write " + tmpName);
+    out.write(StateMagic, sizeof(StateMagic));
+    write64(out, StateVersion);
+    write64(out, columnCount);
+    write64(out, rowCount);
+    write64(out, generation);
+    write64(out, dataSize);
+    write64(out, garbage);
+    firstRow.resize(columnCount);
+    for ( size_t value : firstRow )
+        write64(out, value);
+    constant.resize(columnCount);
+    writeSet(out, constant);
+    write64(out, blocks.size());
+    for ( const Block &block : blocks )
+    {
+        write64(out, block.offset);
+        write64(out, block.first);
+    }
+    write64(out, runs.size());
+    for ( const Run &run : runs )
+    {
+        write64(out, run.offset);
+        write64(out, run.rows);
+    }
+    write64(out, generators.size());
+    for ( const AttributeSet &gen : generators )
+        writeSet(out, gen);
+    out.close();
+    if ( !out || rename(tmpName.c_str(), fileName.c_str()) != 0 )
+        throw runtime_error("cannot write " + fileName);
+    if ( !obsolete.empty() )
+    {
+        unlink(obsolete.c_str());
+        obsolete.clear();
+    }
+}
+
+//----------------- MinerState ----------------------------
+
+void MinerState::create(const string &fileName, const Table &table, const vector<AttributeSet> &generators)
+{
+    remove(fileName);
+    MinerState state(fileName, true);
+    state.store(table);
+    state.generators = generators;
+    state.save();
+}
+
+void MinerState::remove(const string &fileName)
+{
+    if ( !filesystem::exists(fileName) )
+        return;
+    string dataName;
+    {
+        MinerState state(fileName, false);
+        dataName = state.dataFileName(state.generation);
+    }
+    unlink(dataName.c_str());
+    unlink(fileName.c_str());
+}
+
+MinerState::MinerState(const string &fileName) : MinerState(fileName, false)
+{
+    BOOST_LOG_TRIVIAL(info) << "loaded state with " << rowCount << "x" << columnCount << " table, " << runs.size()
+        << " index runs and " << generators.size() << " generators";
+}
+
+MinerState::~MinerState()
+{
+    if ( mapped )
+        munmap(mapped, mappedSize);
+    if ( fd >= 0 )
+        ::close(fd);
+}
+
+size_t MinerState::rows() const
+{
+    return rowCount;
+}
+
+size_t MinerState::columns() const
+{
+    return columnCount;
+}
+
+const vector<AttributeSet>& MinerState::getGenerators() const
+{
+    return generators;
+}
+
+Table MinerState::getTable() const
+{
+    Table table;
+    for ( RowID r = 0; r < rowCount; r++ )
+        table.push_back(Row(row(r), row(r) + columnCount));
+    return table;
+}
+
+void MinerState::append(const Table &newRows)
+{
+    if ( newRows.empty() )
+        return;
+    const size_t firstNew = rowCount;
+    store(newRows);
+    // only pairs involving a new row can have new agree sets; compare each new row with all earlier rows it
+    // shares some value with, which the index runs hold
+    unordered_set<AttributeSet> agreeSets;
+    vector<RowID> others;
+    Row a, b;
+    size_t pairs = 0;
+    for ( RowID id = firstNew; id < rowCount; id++ )
+    {
+        const size_t *cells = row(id);
+        others.clear();
+        for ( size_t col = 0; col < columnCount; col++ )
+            for ( const Run &run : runs )
+            {
+                const IndexEntry *begin = column(run, col), *end = begin + run.rows;
+                auto match = lower_bound(begin, end, cells[col], [](const IndexEntry &e, uint64_t v) { return e.value < v; });
+                for ( ; match < end && match->value == cells[col] && match->row < id; ++match )
+                    others.push_back(match->row);
+            }
+        sort(others.begin(), others.end());
+        others.erase(unique(others.begin(), others.end()), others.end());
+        pairs += others.size();
+        a.assign(cells, cells + columnCount);
+        for ( RowID other : others )
+        {
+            b.assign(row(other), row(other) + columnCount);
+            AttributeSet agreeSet = agreeSetOf(a, b);
+            // duplicate rows have all columns in common, which is never a generator
+            if ( !agreeSet.all() )
+                agreeSets.insert(agreeSet);
+        }
+    }
+    // rows sharing no value agree on the empty set, which is closed unless some column is constant
+    if ( constant.none() && rowCount > 1 )
+        agreeSets.insert(AttributeSet(columnCount));
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": " << agreeSets.size() << " distinct agree sets from " << pairs << " row pairs";
+    // old generators include all maximal anti-lhs among old agree sets, and are agree sets themselves
+    vector<AttributeSet> candidates(agreeSets.begin(), agreeSets.end());
+    candidates.insert(candidates.end(), generators.begin(), generators.end());
+    unordered_set<AttributeSet> result;
+    for ( size_t rhs = 0; rhs < columnCount; rhs++ )
+        for ( const AttributeSet &gen : getMaximalWithout(rhs, candidates) )
+            result.insert(gen);
+    generators.assign(result.begin(), result.end());
+    save();
+}
@@ -0,0 +1,82 @@
+#ifndef AGREE_SET_INCREMENTAL_MINER_H
+#define AGREE_SET_INCREMENTAL_MINER_H
+
+#include <string>
+#include "AgreeSetUtil.h"
+
+/**
+ * everything needed to update generators when rows are appended, kept on disk so that an update only reads and
+ * writes the new rows and the stored rows sharing some value with them (amortized over updates)
+ * fileName holds generators, constant columns and the layout of data file fileName.<generation>, which rows and
+ * runs of per-column value->row index entries are appended to; like a binary counter, runs are merged with the
+ * preceding run once that is no larger, so there are logarithmically many, and once discarded runs make up half
+ * of the data file it is rewritten under the next generation
+ * all operations throw runtime_error on failure
+ */
+class MinerState
+{
+    // a run stores, for each column, entries of its rows sorted by value
+    struct IndexEntry
+    {
+        uint64_t value, row;
+    };
+    struct Run
+    {
+        uint64_t offset, rows;
+    };
+    // consecutive rows starting at row first, stored row by row
+    struct Block
+    {
+        uint64_t offset, first;
+    };
+
+    const std::string fileName;
+    size_t columnCount, rowCount;
+    // bytes of data file in use, and how many of them belong to runs that were merged
+    uint64_t generation, dataSize, garbage;
+    // values of first row, and columns in which all rows agree with it
+    Row firstRow;
+    AttributeSet constant;
+    std::vector<Block> blocks;
+    std::vector<Run> runs;
+    std::vector<AttributeSet> generators;
+    // data file, mapped up to dataSize
+    int fd;
+    void *mapped;
+    size_t mappedSize;
+    // data file replaced by compaction, removed once the state no longer refers to it
+    std::string obsolete;
+
+    MinerState(const std::string &fileName, bool create);
+    std::string dataFileName(uint64_t gen) const;
+    void map();
+    const size_t* row(RowID row) const;
+    const IndexEntry* column(const Run &run, size_t col) const;
+    // writes to end of data file, returns offset written to
+    uint64_t appendData(const void *data, size_t bytes);
+    // appends rows and their index entries, without updating generators
+    void store(const Table &newRows);
+    // rewrites data file without merged runs
+    void compact();
+    // makes data durable, then replaces state file
+    void save();
+public:
+    // creates state for table and its generators, replacing any existing state
+    static void create(const std::string &fileName, const Table &table, const std::vector<AttributeSet> &generators);
+    // removes state file and its data file
+    static void remove(const std::string &fileName);
+    // opens existing state
+    MinerState(const std::string &fileName);
+    MinerState(const MinerState&) = delete;
+    ~MinerState();
+
+    size_t rows() const;
+    size_t columns() const;
+    const std::vector<AttributeSet>& getGenerators() const;
+    // reads all stored rows
+    Table getTable() const;
+    // appends rows and updates generators accordingly, then saves state
+    void append(const Table &newRows);
+};
+
+#endif
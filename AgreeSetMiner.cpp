@@ -1,159 +1,353 @@
 #include <vector>
+#include <memory>
 #include <unordered_set>
 #include <boost/log/trivial.hpp>
-#include <boost/functional/hash.hpp>
 
 #include "AgreeSetMiner.h"
 #include "BoostUtil.h"
 #include "VectorUtil.h"
+#include "OrderedTrie.h"
+#include "HittingSet.h"
+#include "AgreeSetPairMiner.h"
 
 using namespace std;
 
 //----------------- ClosureCalculator ---------------------
 
-ClosureCalculator::ClosureCalculator(const Table &table, size_t columnCount) : table(table), columnCount(columnCount ? columnCount : table[0].size())
+// groupings kept for refinement, limited in number and in total rows stored (as multiple of table rows)
+static const size_t RecentGroupings = 64;
+static const size_t RecentRowsPerTableRow = 4;
+
+ClosureCalculator::ClosureCalculator(const Table &table, size_t columnCount) : ownedColumns(table), columnTable(ownedColumns),
+    columnCount(columnCount ? columnCount : ownedColumns.columns()), passCount(0), recentRows(0)
+{
+}
+
+ClosureCalculator::ClosureCalculator(const ColumnTable &columns) : columnTable(columns), columnCount(columns.columns()), passCount(0), recentRows(0)
 {
 }
 
 AttributeSet ClosureCalculator::operator()(const AttributeSet &x)
 {
-    size_t xHash = boost::hash_value(x);
-    if ( memo.count(xHash) )
+    auto memoized = memo.find(x);
+    if ( memoized != memo.end() )
+    {
+        BOOST_LOG_TRIVIAL(trace) << "closure(" << x << ") = " << memoized->second << " (memoized)";
+        return memoized->second;
+    }
+    passCount++;
+    // group rows on x, refining the finest recent grouping on a subset of x if there is one
+    const Grouping *base = nullptr;
+    for ( const Grouping &g : recent )
+        if ( g.closure.is_subset_of(x) && (base == nullptr || g.closure.count() > base->closure.count()) )
+            base = &g;
+    StrippedPartition partition;
+    if ( base == nullptr )
+        partition = groupRows(indexSetOf(x));
+    else
     {
-        BOOST_LOG_TRIVIAL(trace) << "closure(" << x << ") = " << memo[xHash] << " (memoized via " << xHash << ")";
-        return memo[xHash];
+        // refining by single columns only touches rows in classes, rather than all rows
+        const AttributeSet missing = x - base->closure;
+        partition = base->partition;
+        for ( size_t col = missing.find_first(); col != AttributeSet::npos && partition.size() > 0; col = missing.find_next(col) )
+            partition = partition.refine(columnTable.column(col));
     }
-    // hash rows based on values in x & sort by hash
-    struct RowRef
+    // columns outside x on which all rows sharing a class agree; equality is transitive, so comparing with the
+    // first row of each class suffices
+    AttributeSet open(x);
+    open.flip();
+    for ( size_t c = 0; c < partition.classCount() && open.any(); c++ )
     {
-        const Row *row;
-        size_t hashValue;
-        bool operator<(const RowRef &other) const { return hashValue < other.hashValue; }
-    };
-    vector<RowRef> rowRefs(table.size());
-    IndexSet columnSet = indexSetOf(x);
-    for ( size_t i = 0; i < table.size(); i++ )
+        std::span<const RowID> rows = partition[c];
+        for ( size_t i = 1; i < rows.size() && open.any(); i++ )
+            for ( size_t col = open.find_first(); col != AttributeSet::npos; col = open.find_next(col) )
+            {
+                std::span<const size_t> values = columnTable.column(col);
+                if ( values[rows[i]] != values[rows[0]] )
+                    open.reset(col);
+            }
+    }
+    AttributeSet closure = x | open;
+    assert( x.is_subset_of(closure) );
+    recentRows += partition.size();
+    recent.push_back(Grouping { closure, move(partition) });
+    while ( recent.size() > RecentGroupings || (recent.size() > 1 && recentRows > RecentRowsPerTableRow * columnTable.rows()) )
     {
-        rowRefs[i].row = &table[i];
-        rowRefs[i].hashValue = subHash(table[i], columnSet);
+        recentRows -= recent.front().partition.size();
+        recent.pop_front();
     }
-    sort(rowRefs.begin(), rowRefs.end());
-    // compute closure
-    AttributeSet closure(columnCount);
-    closure.flip();
-    for ( size_t i = 1; i < table.size(); i++ )
-        if ( rowRefs[i].hashValue == rowRefs[i-1].hashValue )
-        {
-            BOOST_LOG_TRIVIAL(trace) << "closure(" << x << "): comparing\n" << *rowRefs[i-1].row << " with\n" << *rowRefs[i].row;
-            for ( size_t col = 0; col < columnCount; col++ )
-                if ( closure[col] )
-                    closure[col] = rowRefs[i].row->at(col) == rowRefs[i-1].row->at(col);
-            assert( x.is_subset_of(closure) );
-        }
-    memo[xHash] = closure;
+    memo[x] = closure;
     BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << "(" << x << ") = " << closure;
     return closure;
 }
 
+StrippedPartition ClosureCalculator::groupRows(const IndexSet &columns)
+{
+    if ( columns.empty() )
+        return StrippedPartition(columnTable.rows());
+    if ( columns.size() == 1 )
+        return StrippedPartition(columnTable.rows()).refine(columnTable.column(columns[0]));
+    // group by hash in a single sort, then verify that rows sharing a class are equal on columns
+    subHashes(columnTable, columns, hashes);
+    StrippedPartition partition = StrippedPartition(columnTable.rows()).refine(hashes);
+    for ( size_t c = 0; c < partition.classCount(); c++ )
+    {
+        std::span<const RowID> rows = partition[c];
+        for ( size_t i = 1; i < rows.size(); i++ )
+            for ( size_t col : columns )
+                if ( columnTable.column(col)[rows[i]] != columnTable.column(col)[rows[0]] )
+                {
+                    BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << ": hash collision, grouping column by column";
+                    partition = StrippedPartition(columnTable.rows());
+                    for ( size_t col : columns )
+                        partition = partition.refine(columnTable.column(col));
+                    return partition;
+                }
+    }
+    return partition;
+}
+
 size_t ClosureCalculator::columns() const
 {
     return columnCount;
 }
 
+const ColumnTable& ClosureCalculator::getColumns() const
+{
+    return columnTable;
+}
+
+size_t ClosureCalculator::passes() const
+{
+    return passCount;
+}
+
+//----------------- sampling ------------------------------
+
+vector<AttributeSet> sampleAgreeSets(const ColumnTable &table, size_t window)
+{
+    const size_t columns = table.columns();
+    vector<span<const size_t>> values;
+    for ( size_t col = 0; col < columns; col++ )
+        values.push_back(table.column(col));
+    unordered_set<AttributeSet> agreeSets;
+    vector<size_t> order(table.rows());
+    for ( size_t col = 0; col < columns; col++ )
+    {
+        // sort by col, then by remaining columns in cyclic order so that similar rows become neighbors
+        for ( size_t i = 0; i < order.size(); i++ )
+            order[i] = i;
+        sort(order.begin(), order.end(), [&values,col,columns](size_t a, size_t b) {
+            for ( size_t offset = 0; offset < columns; offset++ )
+            {
+                size_t c = (col + offset) % columns;
+                if ( values[c][a] != values[c][b] )
+                    return values[c][a] < values[c][b];
+            }
+            return false;
+        });
+        // compare neighbors within clusters
+        for ( size_t i = 0; i < order.size(); i++ )
+        {
+            const size_t row = order[i];
+            for ( size_t j = i + 1; j <= i + window && j < order.size() && values[col][order[j]] == values[col][row]; j++ )
+            {
+                const size_t other = order[j];
+                AttributeSet agreeSet(columns);
+                for ( size_t c = 0; c < columns; c++ )
+                    agreeSet[c] = values[c][row] == values[c][other];
+                if ( !agreeSet.all() )
+                    agreeSets.insert(agreeSet);
+            }
+        }
+    }
+    BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << ": sampled " << agreeSets.size() << " agree sets";
+    return vector<AttributeSet>(agreeSets.begin(), agreeSets.end());
+}
+
+vector<AttributeSet> sampleAgreeSets(const Table &table, size_t window)
+{
+    return sampleAgreeSets(ColumnTable(table), window);
+}
+
 //----------------- main functions ------------------------
 
-bool containsSubset(const vector<AttributeSet> &attSets, const AttributeSet &x)
+vector<AttributeSet> getMaximalWithout(size_t rhs, const vector<AttributeSet> &agreeSets)
+{
+    vector<AttributeSet> candidates;
+    for ( const AttributeSet &ag : agreeSets )
+        if ( !ag[rhs] )
+            candidates.push_back(ag);
+    // larger sets first, so only earlier sets can be strict supersets
+    sort(candidates.begin(), candidates.end(), [](const AttributeSet &a, const AttributeSet &b) { return a.count() > b.count(); });
+    vector<AttributeSet> result;
+    OrderedTrie<size_t,size_t> index;
+    for ( const AttributeSet &candidate : candidates )
+    {
+        IndexSet candidateSet = indexSetOf(candidate);
+        if ( index.findSupersets(candidateSet).empty() )
+        {
+            index.insert(result.size(), candidateSet);
+            result.push_back(candidate);
+        }
+    }
+    return result;
+}
+
+// returns largest set in attSets containing x, or nullptr
+static const AttributeSet* findSuperset(const vector<AttributeSet> &attSets, const AttributeSet &x)
 {
     for ( const AttributeSet &y : attSets )
-        if ( y.is_subset_of(x) )
-            return true;
-    return false;
+        if ( x.is_subset_of(y) )
+            return &y; // attSets is ordered by decreasing size
+    return nullptr;
+}
+
+static unique_ptr<HittingSetEngine> newHittingSetEngine(MinerOptions::Transversals transversals, size_t columns)
+{
+    if ( transversals == MinerOptions::Transversals::MMCS )
+        return make_unique<MMCSHittingSets>(columns);
+    return make_unique<BergeHittingSets>(columns);
 }
 
-// see http://sites.computer.org/debull/A16june/p21.pdf, section 6.1 for core idea
-vector<AttributeSet> getMaxAntiLhs(size_t rhs, ClosureCalculator &closure)
+/**
+ * see http://sites.computer.org/debull/A16june/p21.pdf, section 6.1 for core idea
+ * maximal anti-lhs are found from minimal transversals of their complements
+ * agree sets are closed, so known agree sets not containing rhs (seeds) can stand in for closure calls
+ * anti-lhs contained in known generators are skipped, so only maximal anti-lhs not among them are returned
+ */
+vector<AttributeSet> getMaxAntiLhs(size_t rhs, ClosureCalculator &closure, const vector<AttributeSet> &seeds,
+                                   const vector<AttributeSet> &known, const MinerOptions &options)
 {
     size_t columns = closure.columns();
+    const vector<AttributeSet> antiLhsSeeds = getMaximalWithout(rhs, seeds);
     vector<AttributeSet> maxAntiLhs;
-    vector<AttributeSet> trans = { AttributeSet(columns) }; // transversal of maxLhs
-    while ( !trans.empty() )
+    unique_ptr<HittingSetEngine> trans = newHittingSetEngine(options.transversals, columns);
+    // transversals must not lie within known anti-lhs
+    for ( const AttributeSet &antiLhs : getMaximalWithout(rhs, known) )
     {
-        AttributeSet x = trans.back();
-        AttributeSet cl = closure(x);
+        AttributeSet complement(antiLhs);
+        complement.flip().set(rhs, false);
+        trans->addEdge(complement);
+    }
+    trans->run([&](const AttributeSet &t) {
+        const AttributeSet *seed = findSuperset(antiLhsSeeds, t);
+        AttributeSet cl = seed ? *seed : closure(t);
+        // just accept it - any future super-set generated by t won't be anti-lhs
         if ( cl[rhs] )
-        {
-            // just discard it - any future super-set generated by x won't be anti-lhs
-            trans.pop_back();
-        }
-        else
-        {
-            // maximize x, starting with cl
-            x = cl;
-            for ( size_t c = 0; c < columns; c++ )
-                if ( c != rhs && !x[c] )
-                {
-                    x[c] = true;
-                    cl = closure(x);
-                    if ( cl[rhs] )
-                        x[c] = false;
-                    else
-                        x = cl;
-                }
-            // we found a new maximal anti-LHS
-            maxAntiLhs.push_back(x);
-            BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << "(" << rhs << "): " << x;
-            // update transversal
-            AttributeSet xComplement(x);
-            xComplement.flip().set(rhs, false);
-            IndexSet xCompVec = indexSetOf(xComplement);
-            vector<AttributeSet> newTrans;
-            unordered_set<size_t> newTransSet;
-            size_t next = 0;
-            while ( next < trans.size() )
+            return;
+        // maximize t, starting with cl
+        AttributeSet x = cl;
+        for ( size_t c = 0; c < columns; c++ )
+            if ( c != rhs && !x[c] )
             {
-                AttributeSet &t = trans[next];
-                if ( !t.intersects(xComplement) )
+                x[c] = true;
+                if ( (seed = findSuperset(antiLhsSeeds, x)) != nullptr )
                 {
-                    // extend to new transversal values
-                    for ( size_t att : xCompVec )
-                    {
-                        AttributeSet tExtended(t);
-                        tExtended.set(att);
-                        size_t tExtHash = boost::hash_value(tExtended);
-                        if ( !newTransSet.count(tExtHash) )
-                        {
-                            newTrans.push_back(tExtended);
-                            newTransSet.insert(tExtHash);
-                        }
-                    }
-                    // remove from trans
-                    t = trans.back();
-                    trans.pop_back();
+                    x = *seed;
+                    continue;
                 }
+                cl = closure(x);
+                if ( cl[rhs] )
+                    x[c] = false;
                 else
-                    next++;
+                    x = cl;
             }
-            // minimize transversal - only new transversals need to be checked
-            while ( !newTrans.empty() )
+        // we found a new maximal anti-LHS
+        maxAntiLhs.push_back(x);
+        BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << "(" << rhs << "): " << x;
+        // update transversal
+        AttributeSet xComplement(x);
+        xComplement.flip().set(rhs, false);
+        trans->addEdge(xComplement);
+    });
+    return maxAntiLhs;
+}
+
+void visitGenerators(ClosureCalculator &closure, const MinerOptions &options, const GeneratorSink &sink)
+{
+    size_t columns = closure.columns();
+    vector<AttributeSet> seeds;
+    if ( options.sampleWindow > 0 )
+        seeds = sampleAgreeSets(closure.getColumns(), options.sampleWindow);
+    unordered_set<AttributeSet> generators;
+    // generators found for earlier rhs, if shared between searches
+    vector<AttributeSet> known;
+    for ( size_t rhs = options.shard; rhs < columns; rhs += options.shardCount )
+        for ( AttributeSet const& antiLhs : getMaxAntiLhs(rhs, closure, seeds, known, options) )
+            if ( generators.insert(antiLhs).second )
             {
-                const AttributeSet tNew = newTrans.back(); newTrans.pop_back();
-                if ( !containsSubset(trans, tNew) && !containsSubset(newTrans, tNew) )
-                    trans.push_back(tNew);
+                sink(antiLhs);
+                // maximal anti-lhs are agree sets, so they can seed the remaining searches
+                if ( options.sampleWindow > 0 )
+                    seeds.push_back(antiLhs);
+                if ( options.sharedTraversal )
+                    known.push_back(antiLhs);
             }
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": " << generators.size() << " generators found using " << closure.passes() << " closure passes";
+}
+
+void visitGenerators(const Table &table, const MinerOptions &options, const GeneratorSink &sink)
+{
+    // table may have no columns, e.g. if all columns of a reduced table were constant or unique
+    if ( table.empty() || table[0].empty() )
+        return;
+    if ( options.engine != MinerOptions::Engine::Closure )
+    {
+        vector<vector<RowID>> classes = getMaximalClasses(table);
+        size_t pairs = countClassPairs(classes);
+        if ( options.engine == MinerOptions::Engine::Pairs || preferPairMiner(table, pairs) )
+        {
+            BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << ": comparing " << pairs << " row pairs";
+            for ( const AttributeSet &gen : getPairGenerators(table, classes, options.shard, options.shardCount) )
+                sink(gen);
+            return;
         }
-        BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << "(" << rhs << "): trans = " << trans;
     }
-    return maxAntiLhs;
+    ClosureCalculator closure(table);
+    visitGenerators(closure, options, sink);
 }
 
-vector<AttributeSet> getGenerators(ClosureCalculator &closure)
+void visitGenerators(const ColumnTable &columns, const MinerOptions &options, const GeneratorSink &sink)
+{
+    if ( columns.rows() == 0 || columns.columns() == 0 )
+        return;
+    ClosureCalculator closure(columns);
+    visitGenerators(closure, options, sink);
+}
+
+void visitGenerators(const ReducedTable &reduced, const MinerOptions &options, const GeneratorSink &sink)
+{
+    visitGenerators(reduced.table, options, [&reduced, &sink](const AttributeSet &gen) { sink(reduced.expand(gen)); });
+    // expanding no generators leaves the key agree set only, if there is one
+    for ( const AttributeSet &gen : reduced.expandGenerators(vector<AttributeSet>()) )
+        sink(gen);
+}
+
+template<class T>
+static vector<AttributeSet> collectGenerators(T &source, const MinerOptions &options)
 {
-    size_t columns = closure.columns();
-    unordered_set<AttributeSet> generators;
-    for ( size_t rhs = 0; rhs < columns; ++rhs )
-        for ( AttributeSet const& antiLhs : getMaxAntiLhs(rhs, closure) )
-            generators.insert(antiLhs);
     vector<AttributeSet> result;
-    result.insert(result.end(), generators.begin(), generators.end());
+    visitGenerators(source, options, [&result](const AttributeSet &gen) { result.push_back(gen); });
     return result;
 }
+
+vector<AttributeSet> getGenerators(ClosureCalculator &closure, const MinerOptions &options)
+{
+    return collectGenerators(closure, options);
+}
+
+vector<AttributeSet> getGenerators(const Table &table, const MinerOptions &options)
+{
+    return collectGenerators(table, options);
+}
+
+vector<AttributeSet> getGenerators(const ColumnTable &columns, const MinerOptions &options)
+{
+    return collectGenerators(columns, options);
+}
+
+vector<AttributeSet> getGenerators(const ReducedTable &reduced, const MinerOptions &options)
+{
+    return collectGenerators(reduced, options);
+}
@@ -1,22 +1,94 @@
 #ifndef AGREE_SET_MINER_H
 #define AGREE_SET_MINER_H
 
-#include <map>
+#include <deque>
+#include <functional>
+#include <unordered_map>
 #include "AgreeSetTypes.h"
 #include "AgreeSetUtil.h"
+#include "StrippedPartition.h"
+#include "TableReduction.h"
 
+/**
+ * computes closures by grouping rows on x; groupings of recent closures are kept and refined
+ * one column at a time, so a query x + {c} following x only needs to split the classes of x by c
+ */
 class ClosureCalculator
 {
-    const Table &table;
+    struct Grouping
+    {
+        AttributeSet closure;
+        // rows grouped by values on closure (equivalently, on the set it is the closure of)
+        StrippedPartition partition;
+    };
+    // copy of row-major table, unused if constructed from a column table
+    const ColumnTable ownedColumns;
+    const ColumnTable &columnTable;
     const size_t columnCount;
-    std::map<size_t, AttributeSet> memo;
+    std::unordered_map<AttributeSet, AttributeSet> memo;
+    size_t passCount;
+    // groupings of the most recently computed closures, oldest first
+    std::deque<Grouping> recent;
+    size_t recentRows;
+    // scratch space for row hashes
+    std::vector<uint64_t> hashes;
+
+    // rows grouped by values on columns
+    StrippedPartition groupRows(const IndexSet &columns);
 
 public:
     ClosureCalculator(const Table &table, size_t columnCount = 0);
+    // uses columns directly, e.g. if memory-mapped
+    ClosureCalculator(const ColumnTable &columns);
     AttributeSet operator()(const AttributeSet &x);
     size_t columns() const;
+    const ColumnTable& getColumns() const;
+    // number of closures computed over the full table (i.e. not memoized)
+    size_t passes() const;
+};
+
+struct MinerOptions
+{
+    // Closure searches for maximal anti-lhs, Pairs compares row pairs sharing an equivalence class
+    enum class Engine { Auto, Closure, Pairs };
+    Engine engine = Engine::Auto;
+    // if non-zero, seed search with agree sets of rows at most this far apart in sorted column clusters
+    size_t sampleWindow = 0;
+    // algorithm used to enumerate minimal transversals of maximal anti-lhs complements
+    enum class Transversals { Berge, MMCS };
+    Transversals transversals = Transversals::Berge;
+    // share generators between searches for different rhs, so each generator is found only once
+    bool sharedTraversal = false;
+    // only search for generators maximal without rhs where rhs % shardCount == shard, so that independent jobs can
+    // split the work; the union of all shard results is the set of all generators
+    size_t shard = 0, shardCount = 1;
 };
 
-std::vector<AttributeSet> getGenerators(ClosureCalculator &closure);
+/**
+ * agree sets of row pairs that are close to each other after sorting the equivalence classes of each column
+ * (sorting by the remaining columns, starting with the next one), excluding agree sets of duplicate rows
+ */
+std::vector<AttributeSet> sampleAgreeSets(const ColumnTable &table, size_t window = 1);
+std::vector<AttributeSet> sampleAgreeSets(const Table &table, size_t window = 1);
+
+// maximal sets among agree sets not containing rhs
+std::vector<AttributeSet> getMaximalWithout(size_t rhs, const std::vector<AttributeSet> &agreeSets);
+
+// receives each generator once, as soon as it is found (in no particular order)
+typedef std::function<void(const AttributeSet&)> GeneratorSink;
+
+void visitGenerators(ClosureCalculator &closure, const MinerOptions &options, const GeneratorSink &sink);
+// picks engine based on table shape unless specified in options; pairs engine finds all generators before the first is passed on
+void visitGenerators(const Table &table, const MinerOptions &options, const GeneratorSink &sink);
+// closure engine on a column table, without reduction
+void visitGenerators(const ColumnTable &columns, const MinerOptions &options, const GeneratorSink &sink);
+// mines reduced table and maps generators back to original columns
+void visitGenerators(const ReducedTable &reduced, const MinerOptions &options, const GeneratorSink &sink);
+
+// as above, but collects all generators
+std::vector<AttributeSet> getGenerators(ClosureCalculator &closure, const MinerOptions &options = MinerOptions());
+std::vector<AttributeSet> getGenerators(const Table &table, const MinerOptions &options = MinerOptions());
+std::vector<AttributeSet> getGenerators(const ColumnTable &columns, const MinerOptions &options = MinerOptions());
+std::vector<AttributeSet> getGenerators(const ReducedTable &reduced, const MinerOptions &options = MinerOptions());
 
 #endif
@@ -1,31 +1,224 @@
 #include <boost/functional/hash.hpp>
-#include <boost/tokenizer.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/expressions.hpp>
+#include <boost/program_options.hpp>
 #include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
 
 #include "CSVUtil.h"
 #include "AgreeSetMiner.h"
+#include "AgreeSetIncrementalMiner.h"
 #include "VectorUtil.h"
 #include "BoostUtil.h"
 
 using namespace std;
+namespace po = boost::program_options;
+
+// print to stdout
+static void printGenerator(const AttributeSet &generator)
+{
+    AttributeSet s(generator);
+    boost::reverse(s); // print bits in left-to-right order
+    cout << s << endl;
+}
+
+static void printGenerators(vector<AttributeSet> &generators)
+{
+    sort(generators.begin(), generators.end());
+    for ( const AttributeSet &s : generators )
+        printGenerator(s);
+}
+
+// reads generators printed by shard jobs, throws runtime_error on failure
+static void readGenerators(const string &fileName, unordered_set<AttributeSet> &generators)
+{
+    ifstream in(fileName);
+    if ( !in )
+        throw runtime_error("cannot open " + fileName);
+    AttributeSet gen;
+    while ( in >> gen )
+    {
+        boost::reverse(gen); // bits are stored in left-to-right order
+        if ( !generators.empty() && gen.size() != generators.begin()->size() )
+            throw runtime_error(fileName + " has generators over " + to_string(gen.size()) + " instead of "
+                                + to_string(generators.begin()->size()) + " columns");
+        generators.insert(gen);
+    }
+    if ( !in.eof() )
+        throw runtime_error(fileName + " is not a generator file");
+}
 
 int main(int argc, char *argv[])
 {
-    boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::warning );
-    // read table from stdin
+    string input = "-", stateFile;
+    vector<string> mergeFiles;
+    bool reduce = true, debug = false, columnFile = false, stream = false;
+    MinerOptions options;
+    // extract command-line arguments
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "show options (this)")
+            ("debug,d", "print debug information")
+            ("input,i", po::value<string>(), "CSV file to read (default: stdin)")
+            ("columns", "input is a column file written by columnizer, which is memory-mapped (implies closure engine, no reduction)")
+            ("no-reduce", "keep duplicate rows and constant/unique columns while mining")
+            ("engine,e", po::value<string>(), "mining engine: auto (default), closure or pairs")
+            ("sample,s", po::value<size_t>(), "seed mining with agree sets of rows up to arg apart in sorted column clusters")
+            ("transversals,t", po::value<string>(), "transversal enumeration for closure engine: berge (default) or mmcs")
+            ("state", po::value<string>(), "state file for incremental mining: input rows are appended to the rows stored in it")
+            ("shared", "share generators found between searches for different rhs (closure engine)")
+            ("shard", po::value<string>(), "i/n: only find generators maximal without rhs = i mod n; shard results are combined with --merge")
+            ("merge", po::value<vector<string>>()->multitoken(), "combine generators written by shard jobs instead of mining")
+            ("stream", "print generators as soon as they are found, unsorted")
+        ;
+        po::positional_options_description pos;
+        pos.add("input", 1);
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+        po::notify(vm);
+
+        if ( vm.count("help") )
+        {
+            cout << desc << endl;
+            return 0;
+        }
+        if ( vm.count("input") )
+            input = vm["input"].as<string>();
+        if ( vm.count("debug") )
+            debug = true;
+        if ( vm.count("no-reduce") )
+            reduce = false;
+        if ( vm.count("engine") )
+        {
+            const string engine = vm["engine"].as<string>();
+            if ( engine == "closure" )
+                options.engine = MinerOptions::Engine::Closure;
+            else if ( engine == "pairs" )
+                options.engine = MinerOptions::Engine::Pairs;
+            else if ( engine != "auto" )
+                throw po::error("unknown engine " + engine);
+        }
+        if ( vm.count("sample") )
+            options.sampleWindow = vm["sample"].as<size_t>();
+        if ( vm.count("state") )
+            stateFile = vm["state"].as<string>();
+        if ( vm.count("columns") )
+        {
+            if ( !stateFile.empty() )
+                throw po::error("--columns cannot be combined with --state");
+            columnFile = true;
+        }
+        if ( vm.count("shared") )
+            options.sharedTraversal = true;
+        if ( vm.count("shard") )
+        {
+            const string shard = vm["shard"].as<string>();
+            const size_t slash = shard.find('/');
+            try {
+                if ( slash == string::npos )
+                    throw po::error("");
+                options.shard = stoul(shard.substr(0, slash));
+                options.shardCount = stoul(shard.substr(slash + 1));
+            } catch(exception&) {
+                throw po::error("shard must be given as i/n");
+            }
+            if ( options.shard >= options.shardCount )
+                throw po::error("shard " + shard + " requires i < n");
+            if ( !stateFile.empty() )
+                throw po::error("--shard cannot be combined with --state");
+        }
+        if ( vm.count("merge") )
+            mergeFiles = vm["merge"].as<vector<string>>();
+        if ( vm.count("stream") )
+        {
+            if ( !stateFile.empty() || !mergeFiles.empty() )
+                throw po::error("--stream cannot be combined with --state or --merge");
+            stream = true;
+        }
+        if ( vm.count("transversals") )
+        {
+            const string transversals = vm["transversals"].as<string>();
+            if ( transversals == "mmcs" )
+                options.transversals = MinerOptions::Transversals::MMCS;
+            else if ( transversals != "berge" )
+                throw po::error("unknown transversal algorithm " + transversals);
+        }
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+
+    if ( debug )
+        boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::info );
+    else
+        boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::warning );
+    // shard results only need to be combined
+    vector<AttributeSet> generators;
+    if ( !mergeFiles.empty() )
+    {
+        unordered_set<AttributeSet> merged;
+        try {
+            for ( const string &fileName : mergeFiles )
+                readGenerators(fileName, merged);
+        } catch(exception& e) {
+            cerr << e.what() << "\n";
+            return 1;
+        }
+        generators.assign(merged.begin(), merged.end());
+        printGenerators(generators);
+        return 0;
+    }
+    const GeneratorSink sink = [&](const AttributeSet &gen) {
+        if ( stream )
+            printGenerator(gen);
+        else
+            generators.push_back(gen);
+    };
+    // column files are mined in place, without loading them into memory
+    if ( columnFile )
+    {
+        try {
+            visitGenerators(ColumnTable::map(input), options, sink);
+        } catch(exception& e) {
+            cerr << e.what() << "\n";
+            return 1;
+        }
+        printGenerators(generators);
+        return 0;
+    }
+    // read table from file or stdin
     Table table;
-    read_csv(table, cin);
+    try {
+        read_csv(table, input);
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
     BOOST_LOG_TRIVIAL(debug) << "table = " << table << endl;
     // find generating agree-sets
-    ClosureCalculator closure(table);
-    vector<AttributeSet> generators = getGenerators(closure);
-    // print to stdout
-    sort(generators.begin(), generators.end());
-    for ( AttributeSet &s : generators )
-    {
-        boost::reverse(s); // print bits in left-to-right order
-        cout << s << endl;
+    try {
+        if ( !stateFile.empty() && filesystem::exists(stateFile) )
+        {
+            // only pairs involving new rows need to be compared
+            MinerState state(stateFile);
+            state.append(table);
+            generators = state.getGenerators();
+        }
+        else
+        {
+            if ( reduce )
+                visitGenerators(ReducedTable(table), options, sink);
+            else
+                visitGenerators(table, options, sink);
+            if ( !stateFile.empty() )
+                MinerState::create(stateFile, table, generators);
+        }
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
     }
+    printGenerators(generators);
 }
@@ -0,0 +1,102 @@
+#include <unordered_set>
+#include <boost/log/trivial.hpp>
+
+#include "AgreeSetPairMiner.h"
+#include "AgreeSetMiner.h"
+#include "StrippedPartition.h"
+#include "BoostUtil.h"
+
+using namespace std;
+
+// no class for row in stripped partition
+static const uint32_t NoClass = UINT32_MAX;
+
+vector<vector<RowID>> getMaximalClasses(const Table &table)
+{
+    const size_t columns = table[0].size();
+    vector<StrippedPartition> partitions;
+    for ( size_t col = 0; col < columns; col++ )
+        partitions.push_back(StrippedPartition::ofColumn(table, col));
+    vector<vector<bool>> contained(columns);
+    for ( size_t col = 0; col < columns; col++ )
+        contained[col].resize(partitions[col].classCount(), false);
+    // class c of column a is contained in a class of column b if all its rows share the same class in b
+    vector<uint32_t> classOf(table.size());
+    for ( size_t b = 0; b < columns; b++ )
+    {
+        const StrippedPartition &pb = partitions[b];
+        fill(classOf.begin(), classOf.end(), NoClass);
+        for ( size_t c = 0; c < pb.classCount(); c++ )
+            for ( RowID row : pb[c] )
+                classOf[row] = c;
+        for ( size_t a = 0; a < columns; a++ )
+            for ( size_t c = 0; a != b && c < partitions[a].classCount(); c++ )
+            {
+                std::span<const RowID> rows = partitions[a][c];
+                const uint32_t target = classOf[rows[0]];
+                if ( contained[a][c] || target == NoClass || pb[target].size() < rows.size() )
+                    continue;
+                bool subset = true;
+                for ( RowID row : rows )
+                    if ( classOf[row] != target )
+                    {
+                        subset = false;
+                        break;
+                    }
+                // equal classes are kept once, for the smallest column
+                if ( subset && (pb[target].size() > rows.size() || b < a) )
+                    contained[a][c] = true;
+            }
+    }
+    vector<vector<RowID>> result;
+    for ( size_t col = 0; col < columns; col++ )
+        for ( size_t c = 0; c < partitions[col].classCount(); c++ )
+            if ( !contained[col][c] )
+                result.push_back(vector<RowID>(partitions[col][c].begin(), partitions[col][c].end()));
+    return result;
+}
+
+size_t countClassPairs(const vector<vector<RowID>> &classes)
+{
+    size_t pairs = 0;
+    for ( const vector<RowID> &c : classes )
+        pairs += c.size() * (c.size() - 1) / 2;
+    return pairs;
+}
+
+bool preferPairMiner(const Table &table, size_t pairCount)
+{
+    // closure search tends to need on the order of columns^2 passes over all rows (maximizing and checking
+    // every maximal anti-lhs takes up to one pass per column), while a pair costs a few row hashes
+    const size_t columns = table[0].size();
+    return pairCount <= table.size() * columns * columns;
+}
+
+vector<AttributeSet> getPairGenerators(const Table &table, const vector<vector<RowID>> &maxClasses, size_t shard, size_t shardCount)
+{
+    const size_t columns = table[0].size();
+    unordered_set<AttributeSet> agreeSets;
+    for ( const vector<RowID> &c : maxClasses )
+        for ( size_t i = 0; i < c.size(); i++ )
+            for ( size_t j = i + 1; j < c.size(); j++ )
+            {
+                AttributeSet agreeSet = agreeSetOf(table[c[i]], table[c[j]]);
+                // duplicate rows have all columns in common, which is never a generator
+                if ( !agreeSet.all() )
+                    agreeSets.insert(agreeSet);
+            }
+    // rows sharing no class agree on the empty set, which is closed unless some column is constant
+    bool hasConstant = false;
+    for ( const vector<RowID> &c : maxClasses )
+        hasConstant |= c.size() == table.size();
+    if ( !hasConstant && table.size() > 1 )
+        agreeSets.insert(AttributeSet(columns));
+    BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << ": " << agreeSets.size() << " distinct agree sets";
+    // generators are the maximal agree sets not containing some column
+    const vector<AttributeSet> candidates(agreeSets.begin(), agreeSets.end());
+    unordered_set<AttributeSet> generators;
+    for ( size_t rhs = shard; rhs < columns; rhs += shardCount )
+        for ( const AttributeSet &gen : getMaximalWithout(rhs, candidates) )
+            generators.insert(gen);
+    return vector<AttributeSet>(generators.begin(), generators.end());
+}
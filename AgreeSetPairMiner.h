@@ -0,0 +1,19 @@
+#ifndef AGREE_SET_PAIR_MINER_H
+#define AGREE_SET_PAIR_MINER_H
+
+#include "AgreeSetUtil.h"
+
+/**
+ * equivalence classes of single columns that are not contained in a class of another column
+ * every row pair agreeing on some column lies within one of these
+ */
+std::vector<std::vector<RowID>> getMaximalClasses(const Table &table);
+// number of row pairs within classes
+size_t countClassPairs(const std::vector<std::vector<RowID>> &classes);
+// true if comparing the given number of row pairs is expected to be cheaper than closure search
+bool preferPairMiner(const Table &table, size_t pairCount);
+// generators computed from agree sets of all row pairs within maximal classes, restricted to rhs in shard
+std::vector<AttributeSet> getPairGenerators(const Table &table, const std::vector<std::vector<RowID>> &maxClasses,
+                                            size_t shard = 0, size_t shardCount = 1);
+
+#endif
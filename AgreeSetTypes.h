@@ -6,6 +6,8 @@
 
 typedef std::vector<size_t> Row;
 typedef std::vector<Row> Table;
+// rows are referred to by their index in the table
+typedef uint32_t RowID;
 // attributes are encoded as integers 0..k
 typedef boost::dynamic_bitset<> AttributeSet;
 
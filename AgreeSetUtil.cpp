@@ -1,9 +1,13 @@
-#include <boost/functional/hash.hpp>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "AgreeSetUtil.h"
 
 using namespace std;
 
+//----------------- hashing & comparison ------------------
+
 IndexSet indexSetOf(const AttributeSet &x)
 {
     IndexSet result;
@@ -13,11 +17,59 @@ IndexSet indexSetOf(const AttributeSet &x)
     return result;
 }
 
-size_t subHash(const Row &row, const IndexSet &x)
+// folds value into hash; injective in value for fixed hash, so single-column hashes never collide
+static inline uint64_t combine(uint64_t hash, uint64_t value)
+{
+    const uint64_t k = (hash ^ value) * 0x9e3779b97f4a7c15ULL;
+    return k ^ (k >> 32);
+}
+
+void subHashes(const ColumnTable &table, const IndexSet &x, vector<uint64_t> &hashes)
 {
-    size_t seed = 0;
-    for ( size_t index : x )
-        // see https://stackoverflow.com/questions/19966041/getting-too-many-collisions-with-hash-combine
-        boost::hash_combine(seed, row[index] * 2654435761);
-    return seed;
+    const size_t rows = table.rows();
+    hashes.assign(rows, 0);
+    uint64_t *__restrict h = hashes.data();
+    size_t next = 0;
+    // two columns per pass halve the traffic on hashes
+    for ( ; next + 2 <= x.size(); next += 2 )
+    {
+        const size_t *__restrict a = table.column(x[next]).data();
+        const size_t *__restrict b = table.column(x[next + 1]).data();
+        for ( size_t i = 0; i < rows; i++ )
+            h[i] = combine(combine(h[i], a[i]), b[i]);
+    }
+    if ( next < x.size() )
+    {
+        const size_t *__restrict a = table.column(x[next]).data();
+        for ( size_t i = 0; i < rows; i++ )
+            h[i] = combine(h[i], a[i]);
+    }
+    for ( size_t i = 0; i < rows; i++ )
+        h[i] = fmix64(h[i]);
+}
+
+AttributeSet agreeSetOf(const Row &a, const Row &b)
+{
+    typedef AttributeSet::block_type Block;
+    const size_t columns = a.size(), blockBits = AttributeSet::bits_per_block;
+    vector<Block> blocks((columns + blockBits - 1) / blockBits, 0);
+    size_t col = 0;
+#ifdef __SSE2__
+    // compare two 64-bit cells at once; cells are equal if both 32-bit halves are
+    static_assert(sizeof(size_t) == 8, "SSE2 comparison assumes 64-bit cells");
+    for ( ; col + 2 <= columns; col += 2 )
+    {
+        const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&a[col])),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b[col])));
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        const Block bits = ((mask & 3) == 3) | (((mask & 12) == 12) << 1);
+        blocks[col / blockBits] |= bits << (col % blockBits);
+    }
+#endif
+    for ( ; col < columns; col++ )
+        if ( a[col] == b[col] )
+            blocks[col / blockBits] |= Block(1) << (col % blockBits);
+    AttributeSet result(blocks.begin(), blocks.end());
+    result.resize(columns);
+    return result;
 }
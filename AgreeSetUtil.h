@@ -2,10 +2,25 @@
 #define AGREE_SET_UTIL_H
 
 #include "AgreeSetTypes.h"
+#include "ColumnTable.h"
 
 typedef std::vector<size_t> IndexSet;
 
+// finalizer of MurmurHash3, every input bit affects every output bit
+inline uint64_t fmix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
 IndexSet indexSetOf(const AttributeSet &x);
-size_t subHash(const Row &row, const IndexSet &x);
+// hashes of all rows restricted to columns x, computed in passes over two columns at a time
+void subHashes(const ColumnTable &table, const IndexSet &x, std::vector<uint64_t> &hashes);
+// columns on which both rows agree
+AttributeSet agreeSetOf(const Row &a, const Row &b);
 
 #endif
@@ -16,7 +16,7 @@ int main(int argc, char* argv[])
 {
     size_t max_agree_set = 0;
     unsigned int max_backtrack = UINT_MAX;
-    bool show_debug = false, show_trace = false;
+    bool show_debug = false, show_trace = false, is_generators = false;
 
     // extract command-line arguments
     try {
@@ -27,6 +27,7 @@ int main(int argc, char* argv[])
             ("trace,t", "print trace information (including debug)")
             ("ag,a", po::value<size_t>(), "set limit on agree-sets")
             ("bt,b", po::value<unsigned int>(), "set limit on backtracking steps")
+            ("generators,g", "input agree-sets are generators (e.g. miner output), skip reduction")
         ;
         po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -45,6 +46,8 @@ int main(int argc, char* argv[])
             max_agree_set = vm["ag"].as<size_t>();
         if ( vm.count("bt") )
             max_backtrack = vm["bt"].as<unsigned int>();
+        if ( vm.count("generators") )
+            is_generators = true;
     }
     catch(exception& e) {
         cerr << e.what() << "\n";
@@ -93,7 +96,7 @@ int main(int argc, char* argv[])
     else
         BOOST_LOG_TRIVIAL(info) << "finding Armstrong table for " << agreeSets.size() << " agree-sets";
     // find armstrong table
-    AgreeSetGraph g = findMinAgreeSetGraph(agreeSets, max_backtrack);
+    AgreeSetGraph g = findMinAgreeSetGraph(agreeSets, max_backtrack, is_generators);
     //cout << g << endl;
     for ( vector<int> row : g.toArmstrongTable() )
         cout << row << endl;
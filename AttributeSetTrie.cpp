@@ -0,0 +1,123 @@
+#include <algorithm>
+
+#include "AttributeSetTrie.h"
+
+using namespace std;
+
+typedef pair<size_t, uint32_t> Child;
+
+static bool byAttribute(const Child &child, size_t att)
+{
+    return child.first < att;
+}
+
+AttributeSetTrie::AttributeSetTrie() : nodes(1), setCount(0)
+{
+}
+
+uint32_t AttributeSetTrie::newNode()
+{
+    if ( freeNodes.empty() )
+    {
+        nodes.push_back(Node());
+        return nodes.size() - 1;
+    }
+    uint32_t node = freeNodes.back();
+    freeNodes.pop_back();
+    return node;
+}
+
+bool AttributeSetTrie::containsSubset(uint32_t node, const AttributeSet &x, size_t depth, size_t maxDepth) const
+{
+    if ( nodes[node].terminal && depth < maxDepth )
+        return true;
+    for ( const Child &child : nodes[node].children )
+        if ( x[child.first] && containsSubset(child.second, x, depth + 1, maxDepth) )
+            return true;
+    return false;
+}
+
+size_t AttributeSetTrie::size() const
+{
+    return setCount;
+}
+
+bool AttributeSetTrie::contains(const AttributeSet &x) const
+{
+    uint32_t node = 0;
+    for ( size_t att = x.find_first(); att != AttributeSet::npos; att = x.find_next(att) )
+    {
+        const vector<Child> &children = nodes[node].children;
+        auto child = lower_bound(children.begin(), children.end(), att, byAttribute);
+        if ( child == children.end() || child->first != att )
+            return false;
+        node = child->second;
+    }
+    return nodes[node].terminal;
+}
+
+bool AttributeSetTrie::insert(const AttributeSet &x)
+{
+    uint32_t node = 0;
+    for ( size_t att = x.find_first(); att != AttributeSet::npos; att = x.find_next(att) )
+    {
+        vector<Child> &children = nodes[node].children;
+        auto child = lower_bound(children.begin(), children.end(), att, byAttribute);
+        if ( child == children.end() || child->first != att )
+        {
+            // newNode may reallocate nodes, invalidating children
+            const size_t pos = child - children.begin();
+            const uint32_t created = newNode();
+            nodes[node].children.insert(nodes[node].children.begin() + pos, Child(att, created));
+            node = created;
+        }
+        else
+            node = child->second;
+    }
+    if ( nodes[node].terminal )
+        return false;
+    nodes[node].terminal = true;
+    setCount++;
+    return true;
+}
+
+bool AttributeSetTrie::erase(const AttributeSet &x)
+{
+    // remember path for pruning
+    vector<uint32_t> path = { 0 };
+    vector<size_t> atts;
+    for ( size_t att = x.find_first(); att != AttributeSet::npos; att = x.find_next(att) )
+    {
+        const vector<Child> &children = nodes[path.back()].children;
+        auto child = lower_bound(children.begin(), children.end(), att, byAttribute);
+        if ( child == children.end() || child->first != att )
+            return false;
+        path.push_back(child->second);
+        atts.push_back(att);
+    }
+    if ( !nodes[path.back()].terminal )
+        return false;
+    nodes[path.back()].terminal = false;
+    setCount--;
+    // remove nodes that no longer lead to any set
+    for ( size_t depth = atts.size(); depth > 0; depth-- )
+    {
+        const Node &n = nodes[path[depth]];
+        if ( n.terminal || !n.children.empty() )
+            break;
+        vector<Child> &siblings = nodes[path[depth - 1]].children;
+        siblings.erase(lower_bound(siblings.begin(), siblings.end(), atts[depth - 1], byAttribute));
+        freeNodes.push_back(path[depth]);
+    }
+    return true;
+}
+
+bool AttributeSetTrie::containsSubset(const AttributeSet &x) const
+{
+    return containsSubset(0, x, 0, x.size() + 1);
+}
+
+bool AttributeSetTrie::containsStrictSubset(const AttributeSet &x) const
+{
+    return containsSubset(0, x, 0, x.count());
+}
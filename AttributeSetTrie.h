@@ -0,0 +1,40 @@
+#ifndef ATTRIBUTE_SET_TRIE_H
+#define ATTRIBUTE_SET_TRIE_H
+
+#include "AgreeSetTypes.h"
+
+/**
+ * set-trie storing a collection of attribute sets
+ * subset queries only visit trie paths made up of attributes of the query set
+ */
+class AttributeSetTrie
+{
+    struct Node
+    {
+        // (attribute, node index) pairs, sorted by attribute
+        std::vector<std::pair<size_t, uint32_t>> children;
+        bool terminal = false;
+    };
+    // node 0 is the root, erased nodes are recycled via freeNodes
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    size_t setCount;
+
+    uint32_t newNode();
+    bool containsSubset(uint32_t node, const AttributeSet &x, size_t depth, size_t maxDepth) const;
+public:
+    AttributeSetTrie();
+
+    size_t size() const;
+    bool contains(const AttributeSet &x) const;
+    // returns false if x was stored already
+    bool insert(const AttributeSet &x);
+    // returns false if x was not stored
+    bool erase(const AttributeSet &x);
+    // true if some stored set is a subset of x
+    bool containsSubset(const AttributeSet &x) const;
+    // true if some stored set other than x is a subset of x
+    bool containsStrictSubset(const AttributeSet &x) const;
+};
+
+#endif
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <boost/log/expressions.hpp>
+
+#include "OrderedTrie.h"
+#include "SignatureIndex.h"
+
+using namespace std;
+
+typedef uint32_t ID;
+typedef uint32_t Label;
+typedef vector<Label> Set;
+
+// node-by-value trie with separate value map as previously used by DominanceGraph, for comparison
+class LegacyTrie
+{
+    struct Node
+    {
+        vector<ID> ids;
+        vector<pair<Label,Node>> children;
+
+        bool empty() const
+        {
+            return ids.empty() && children.empty();
+        }
+        void insert(ID id, const Set &value, size_t index)
+        {
+            if ( index >= value.size() )
+            {
+                ids.push_back(id);
+                return;
+            }
+            auto child = children.begin();
+            while ( child < children.end() && child->first < value[index] )
+                child++;
+            if ( child == children.end() || child->first > value[index] )
+                child = children.insert(child, pair<Label,Node>(value[index], Node()));
+            child->second.insert(id, value, index + 1);
+        }
+        void erase(ID id, const Set &value, size_t index)
+        {
+            if ( index >= value.size() )
+            {
+                size_t pos = 0;
+                while ( ids[pos] != id )
+                    pos++;
+                ids[pos] = ids.back();
+                ids.pop_back();
+                return;
+            }
+            auto child = children.begin();
+            while ( child->first != value[index] )
+                ++child;
+            child->second.erase(id, value, index + 1);
+            if ( child->second.empty() )
+                children.erase(child);
+        }
+        void findSubsets(const Set &s, size_t index, vector<ID> &out) const
+        {
+            out.insert(out.end(), ids.begin(), ids.end());
+            auto child = children.begin();
+            while ( index < s.size() && child < children.end() )
+            {
+                if ( s[index] < child->first )
+                    index++;
+                else if ( s[index] > child->first )
+                    child++;
+                else
+                    (child++)->second.findSubsets(s, ++index, out);
+            }
+        }
+        void findSupersets(const Set &s, size_t index, vector<ID> &out) const
+        {
+            if ( index >= s.size() )
+            {
+                out.insert(out.end(), ids.begin(), ids.end());
+                for ( const pair<Label,Node> &child : children )
+                    child.second.findSupersets(s, index, out);
+                return;
+            }
+            for ( const pair<Label,Node> &child : children )
+            {
+                if ( s[index] < child.first )
+                    break;
+                child.second.findSupersets(s, s[index] == child.first ? index + 1 : index, out);
+            }
+        }
+    };
+
+    Node root;
+    unordered_map<ID,Set> valueMap;
+public:
+    bool insert(ID id, const Set &value)
+    {
+        auto it = valueMap.find(id);
+        if ( it != valueMap.end() )
+        {
+            if ( it->second == value )
+                return false;
+            root.erase(id, it->second, 0);
+        }
+        root.insert(id, value, 0);
+        valueMap[id] = value;
+        return true;
+    }
+    bool erase(ID id)
+    {
+        auto it = valueMap.find(id);
+        if ( it == valueMap.end() )
+            return false;
+        root.erase(id, it->second, 0);
+        valueMap.erase(it);
+        return true;
+    }
+    vector<ID> findSubsets(const Set &s) const
+    {
+        vector<ID> out;
+        root.findSubsets(s, 0, out);
+        return out;
+    }
+    vector<ID> findSupersets(const Set &s) const
+    {
+        vector<ID> out;
+        root.findSupersets(s, 0, out);
+        return out;
+    }
+};
+
+// random sorted sets with skewed labels, resembling agree sets adjacent to nodes of informative graphs
+static Set randomSet(mt19937_64 &rng, size_t labels)
+{
+    geometric_distribution<size_t> size(0.1), label(20.0 / labels);
+    Set s;
+    for ( size_t i = size(rng) + 1; i > 0; i-- )
+        s.push_back(label(rng) % labels);
+    sort(s.begin(), s.end());
+    s.erase(unique(s.begin(), s.end()), s.end());
+    return s;
+}
+
+template <typename F>
+static double seconds(F f)
+{
+    typedef chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+    f();
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// runs same operations on any index, printing time taken per phase
+template <typename Trie>
+static size_t run(const string &name, const vector<pair<ID,Set>> &sets, const vector<Set> &updates, Trie trie)
+{
+    size_t check = 0;
+    cout << name << ":";
+    cout << " insert " << seconds([&]() {
+        for ( const pair<ID,Set> &entry : sets )
+            trie.insert(entry.first, entry.second);
+    }) << "s" << flush;
+    // superset queries for small sets visit most of the trie, so only query a sample
+    cout << ", query " << seconds([&]() {
+        for ( size_t i = 0; i < sets.size(); i += 10 )
+            check += trie.findSupersets(sets[i].second).size() + trie.findSubsets(sets[i].second).size();
+    }) << "s" << flush;
+    cout << ", update " << seconds([&]() {
+        for ( ID id = 0; id < updates.size(); id++ )
+            check += trie.insert(id, updates[id]);
+    }) << "s" << flush;
+    cout << ", erase " << seconds([&]() {
+        for ( ID id = 0; id < sets.size(); id++ )
+            check += trie.erase(id);
+    }) << "s" << endl;
+    return check;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t count = argc > 1 ? stoul(argv[1]) : 20000, labels = 3000;
+    // queries log at debug level
+    boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::warning );
+    mt19937_64 rng(42);
+    vector<pair<ID,Set>> sets;
+    vector<Set> updates;
+    for ( ID id = 0; id < count; id++ )
+        sets.push_back(make_pair(id, randomSet(rng, labels)));
+    // updates mostly shrink sets, as removing edges does
+    for ( const pair<ID,Set> &entry : sets )
+    {
+        Set s = entry.second;
+        s.erase(s.begin() + rng() % s.size());
+        updates.push_back(s);
+    }
+    cout << "sets=" << count << " labels=" << labels << endl;
+    size_t check = run("legacy", sets, updates, LegacyTrie());
+    check += run("arena", sets, updates, OrderedTrie<ID,Label>());
+    check += run("signature", sets, updates, SignatureIndex<ID,Label>());
+    // bulk loading lays out nodes in depth-first order
+    OrderedTrie<ID,Label> bulk;
+    cout << "arena: bulk load " << seconds([&]() {
+        bulk = OrderedTrie<ID,Label>(sets);
+    }) << "s" << flush;
+    cout << ", query " << seconds([&]() {
+        for ( size_t i = 0; i < sets.size(); i += 10 )
+            check += bulk.findSupersets(sets[i].second).size() + bulk.findSubsets(sets[i].second).size();
+    }) << "s" << endl;
+    // keep results alive
+    return check == 42;
+}
@@ -0,0 +1,67 @@
+#include <boost/functional/hash.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "AgreeSetUtil.h"
+
+using namespace std;
+
+// row-at-a-time hashing as previously used by ClosureCalculator, for comparison
+static size_t legacySubHash(const Row &row, const IndexSet &x)
+{
+    size_t seed = 0;
+    for ( size_t index : x )
+        boost::hash_combine(seed, row[index] * 2654435761);
+    return seed;
+}
+
+// runs f repeatedly for about a second, returns GB of selected cells hashed per second
+template <typename F>
+static double measure(size_t bytesPerRun, F f)
+{
+    typedef chrono::steady_clock Clock;
+    size_t runs = 0;
+    const Clock::time_point start = Clock::now();
+    double seconds;
+    do
+    {
+        f();
+        runs++;
+        seconds = chrono::duration<double>(Clock::now() - start).count();
+    } while ( seconds < 1.0 );
+    return bytesPerRun * runs / seconds / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t rows = argc > 1 ? stoul(argv[1]) : 1000000, columns = 40;
+    mt19937_64 rng(42);
+    Table table(rows, Row(columns));
+    for ( Row &row : table )
+        for ( size_t &cell : row )
+            cell = rng();
+    const ColumnTable columnTable(table);
+    vector<uint64_t> hashes;
+    uint64_t check = 0;
+    cout << "rows=" << rows << " columns=" << columns << endl;
+    for ( size_t width : { 1, 2, 4, 8, 16 } )
+    {
+        // spread selected columns out over the row
+        IndexSet x;
+        for ( size_t i = 0; i < width; i++ )
+            x.push_back(i * columns / width);
+        const size_t bytes = rows * width * sizeof(size_t);
+        const double legacy = measure(bytes, [&]() {
+            for ( const Row &row : table )
+                check += legacySubHash(row, x);
+        });
+        const double batch = measure(bytes, [&]() {
+            subHashes(columnTable, x, hashes);
+            check += hashes[0];
+        });
+        cout << "|x|=" << width << ": legacy " << legacy << " GB/s, subHashes " << batch << " GB/s" << endl;
+    }
+    // keep results alive
+    return check == 42;
+}
@@ -1,22 +1,336 @@
-#include <boost/functional/hash.hpp>
-#include <boost/tokenizer.hpp>
-#include <iostream>
+#include <cstring>
+#include <stdexcept>
+#include <sstream>
+#include <thread>
+#include <exception>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "CSVUtil.h"
-#include "BoostUtil.h"
+#include "AgreeSetUtil.h"
 
 using namespace std;
 
-void read_csv(Table &t, istream &in)
+// chunks smaller than this are not worth a thread of their own
+static const size_t MinChunkSize = 1 << 20;
+
+//----------------- scanning & hashing --------------------
+
+// returns first position in [p,end) holding one of the characters in Special, or end
+template <char... Special>
+static const char* findNext(const char *p, const char *end)
+{
+#ifdef __SSE2__
+    while ( p + 16 <= end )
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i match = _mm_setzero_si128();
+        ((match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_set1_epi8(Special)))), ...);
+        const int mask = _mm_movemask_epi8(match);
+        if ( mask )
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while ( p < end && !((*p == Special) || ...) )
+        p++;
+    return p;
+}
+
+// hashes 8 bytes at a time; length is part of the seed so that trailing zero bytes matter
+static uint64_t hashBytes(const char *s, size_t n)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (n * 0xc2b2ae3d27d4eb4fULL);
+    uint64_t word;
+    for ( ; n >= 8; s += 8, n -= 8 )
+    {
+        memcpy(&word, s, 8);
+        h = ((h << 27) | (h >> 37)) ^ (word * 0x87c37b91114253d5ULL);
+        h = h * 5 + 0x52dce729;
+    }
+    if ( n > 0 )
+    {
+        word = 0;
+        memcpy(&word, s, n);
+        h = ((h << 27) | (h >> 37)) ^ (word * 0x87c37b91114253d5ULL);
+    }
+    return fmix64(h);
+}
+
+// unescape & unquote cell content into scratch, then hash
+static uint64_t hashDecoded(const char *p, const char *end, string &scratch)
+{
+    scratch.clear();
+    for ( ; p < end; p++ )
+        if ( *p == '\\' )
+        {
+            if ( ++p == end )
+                throw runtime_error("cannot end with escape");
+            if ( *p == 'n' )
+                scratch += '\n';
+            else if ( *p == '"' || *p == ',' || *p == '\\' )
+                scratch += *p;
+            else
+                throw runtime_error("unknown escape sequence");
+        }
+        else if ( *p != '"' )
+            scratch += *p;
+    return hashBytes(scratch.data(), scratch.size());
+}
+
+//----------------- chunked parsing -----------------------
+
+// parse complete rows in [p,end), where p must be the start of a row
+static void parseRows(const char *p, const char *end, Table &t)
 {
-    string line;
-    boost::hash<string> sHash;
-    while ( getline(in, line) )
+    string scratch;
+    size_t width = 0;
+    while ( p < end )
     {
-        boost::tokenizer<boost::escaped_list_separator<char>> tok(line);
+        // skip blank lines
+        if ( *p == '\n' )
+        {
+            p++;
+            continue;
+        }
+        if ( *p == '\r' && p + 1 < end && p[1] == '\n' )
+        {
+            p += 2;
+            continue;
+        }
         Row row;
-        for ( const string &s : tok )
-            row.push_back(sHash(s));
-        t.push_back(row);
+        row.reserve(width);
+        while ( true )
+        {
+            // find end of cell
+            const char *cellStart = p;
+            bool plain = true, inQuote = false;
+            while ( (p = findNext<',', '"', '\\', '\n', '\r'>(p, end)) < end )
+            {
+                if ( *p == '\\' )
+                {
+                    plain = false;
+                    if ( p + 1 == end )
+                        throw runtime_error("cannot end with escape");
+                    p += 2;
+                }
+                else if ( *p == '"' )
+                {
+                    plain = false;
+                    inQuote = !inQuote;
+                    p++;
+                }
+                else if ( inQuote || (*p == '\r' && !(p + 1 < end && p[1] == '\n')) )
+                    p++;
+                else
+                    break;
+            }
+            row.push_back(plain ? hashBytes(cellStart, p - cellStart) : hashDecoded(cellStart, p, scratch));
+            if ( p < end && *p == ',' )
+                p++;
+            else
+                break;
+        }
+        // skip line break
+        if ( p < end && *p == '\r' )
+            p++;
+        if ( p < end )
+            p++;
+        width = row.size();
+        t.push_back(move(row));
+    }
+}
+
+// counts unescaped quotes in [p,end); escaped is set if *p is preceded by an unpaired escape
+static size_t countQuotes(const char *p, const char *end, bool escaped)
+{
+    size_t count = 0;
+    if ( escaped )
+        p++;
+    while ( (p = findNext<'"', '\\'>(p, end)) < end )
+    {
+        if ( *p == '"' )
+            count++;
+        p += *p == '\\' ? 2 : 1;
+    }
+    return count;
+}
+
+static bool escapedAt(const char *data, const char *p)
+{
+    size_t escapes = 0;
+    while ( p > data && *(p - 1) == '\\' )
+    {
+        escapes++;
+        p--;
+    }
+    return escapes % 2;
+}
+
+// returns the start of the first row beginning at or after p, given the quoting state at p
+static const char* nextRowStart(const char *p, const char *end, bool inQuote, bool escaped)
+{
+    if ( escaped )
+        p++;
+    while ( (p = findNext<'"', '\\', '\n'>(p, end)) < end )
+    {
+        if ( *p == '\\' )
+            p += 2;
+        else if ( *p == '"' )
+        {
+            inQuote = !inQuote;
+            p++;
+        }
+        else if ( !inQuote )
+            return p + 1;
+        else
+            p++;
     }
+    return end;
+}
+
+// runs f(i) for i = 0..count-1 on separate threads, rethrowing the first exception raised
+template <typename F>
+static void runParallel(size_t count, F f)
+{
+    vector<exception_ptr> errors(count);
+    vector<thread> threads;
+    for ( size_t i = 0; i < count; i++ )
+        threads.emplace_back([&f,&errors,i]() {
+            try { f(i); }
+            catch (...) { errors[i] = current_exception(); }
+        });
+    for ( thread &th : threads )
+        th.join();
+    for ( exception_ptr &e : errors )
+        if ( e )
+            rethrow_exception(e);
+}
+
+void parse_csv(Table &t, const char *data, size_t size, unsigned chunks)
+{
+    const char *end = data + size;
+    if ( chunks == 0 )
+        chunks = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), size / MinChunkSize));
+    chunks = max<size_t>(1, min<size_t>(chunks, size));
+    if ( chunks == 1 )
+    {
+        parseRows(data, end, t);
+        return;
+    }
+    // quotes may span chunk boundaries, so determine quoting state at chunk starts first
+    vector<const char*> chunkStart(chunks + 1);
+    for ( size_t i = 0; i <= chunks; i++ )
+        chunkStart[i] = data + size * i / chunks;
+    vector<size_t> quotes(chunks);
+    runParallel(chunks, [&](size_t i) {
+        quotes[i] = countQuotes(chunkStart[i], chunkStart[i+1], escapedAt(data, chunkStart[i]));
+    });
+    // each chunk parses the rows starting within it
+    vector<const char*> rowStart(chunks + 1, end);
+    rowStart[0] = data;
+    bool inQuote = false;
+    for ( size_t i = 1; i < chunks; i++ )
+    {
+        inQuote ^= quotes[i-1] % 2;
+        rowStart[i] = nextRowStart(chunkStart[i], end, inQuote, escapedAt(data, chunkStart[i]));
+    }
+    vector<Table> parts(chunks);
+    runParallel(chunks, [&](size_t i) {
+        if ( rowStart[i] < rowStart[i+1] )
+            parseRows(rowStart[i], rowStart[i+1], parts[i]);
+    });
+    for ( Table &part : parts )
+    {
+        if ( t.empty() )
+            t = move(part);
+        else
+            move(part.begin(), part.end(), back_inserter(t));
+    }
+}
+
+//----------------- input sources -------------------------
+
+void read_csv(Table &t, istream &in)
+{
+    ostringstream buffer;
+    buffer << in.rdbuf();
+    const string data = buffer.str();
+    parse_csv(t, data.data(), data.size());
+}
+
+// calls process on the content of the file, which is memory-mapped if possible
+static void withContent(const string &fileName, const function<void(const char*, size_t)> &process)
+{
+    const bool useStdin = fileName == "-";
+    const int fd = useStdin ? STDIN_FILENO : open(fileName.c_str(), O_RDONLY);
+    if ( fd < 0 )
+        throw runtime_error("cannot open " + fileName + ": " + strerror(errno));
+    struct stat info;
+    if ( fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 )
+    {
+        void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if ( mapped != MAP_FAILED )
+        {
+            madvise(mapped, info.st_size, MADV_WILLNEED);
+            try {
+                process(static_cast<const char*>(mapped), info.st_size);
+            } catch (...) {
+                munmap(mapped, info.st_size);
+                if ( !useStdin )
+                    close(fd);
+                throw;
+            }
+            munmap(mapped, info.st_size);
+            if ( !useStdin )
+                close(fd);
+            return;
+        }
+    }
+    // pipes and other unmappable inputs are read into memory
+    string data;
+    char buffer[1 << 16];
+    ssize_t bytes;
+    while ( (bytes = read(fd, buffer, sizeof(buffer))) > 0 )
+        data.append(buffer, bytes);
+    if ( !useStdin )
+        close(fd);
+    if ( bytes < 0 )
+        throw runtime_error("cannot read " + fileName + ": " + strerror(errno));
+    process(data.data(), data.size());
+}
+
+void read_csv(Table &t, const string &fileName)
+{
+    withContent(fileName, [&t](const char *data, size_t size) { parse_csv(t, data, size); });
+}
+
+void parse_csv_chunks(const char *data, size_t size, size_t chunkBytes, const function<void(Table&)> &consume)
+{
+    const char *end = data + size;
+    for ( const char *start = data; start < end; )
+    {
+        // start is the beginning of a row, so quoting state at the target position follows from quote count
+        const char *next = end;
+        if ( size_t(end - start) > chunkBytes )
+        {
+            const char *target = start + chunkBytes;
+            const bool inQuote = countQuotes(start, target, false) % 2;
+            next = nextRowStart(target, end, inQuote, escapedAt(data, target));
+        }
+        Table t;
+        parse_csv(t, start, next - start);
+        consume(t);
+        start = next;
+    }
+}
+
+void read_csv_chunks(const string &fileName, size_t chunkBytes, const function<void(Table&)> &consume)
+{
+    withContent(fileName, [&](const char *data, size_t size) { parse_csv_chunks(data, size, chunkBytes, consume); });
 }
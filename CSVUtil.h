@@ -1,9 +1,24 @@
 #ifndef CSV_UTIL_H
 #define CSV_UTIL_H
 
+#include <functional>
 #include <iostream>
+#include <string>
 #include "AgreeSetTypes.h"
 
+/**
+ * CSV syntax is close to boost::escaped_list_separator: ',' separates cells, '"' toggles quoting
+ * and quoted cells may span multiple lines; accepted escapes are \\, \", \n and, unlike boost, \,
+ * cells are stored as 64-bit hashes of their (unescaped) content, blank lines are skipped
+ */
 void read_csv(Table &t, std::istream &in);
+// memory-maps file if possible; "-" reads stdin, which is mapped if it is redirected from a regular file
+void read_csv(Table &t, const std::string &fileName);
+// parses in-memory CSV data using the given number of chunks (0 = one per core for large data)
+void parse_csv(Table &t, const char *data, size_t size, unsigned chunks = 0);
+// parses data in pieces of about chunkBytes ending at row boundaries, passing the rows of each to consume
+void parse_csv_chunks(const char *data, size_t size, size_t chunkBytes, const std::function<void(Table&)> &consume);
+// as above, for file or stdin ("-"), which are memory-mapped if possible
+void read_csv_chunks(const std::string &fileName, size_t chunkBytes, const std::function<void(Table&)> &consume);
 
 #endif
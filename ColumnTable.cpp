@@ -0,0 +1,143 @@
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ColumnTable.h"
+
+using namespace std;
+
+static const char ColumnMagic[8] = { 'A', 'S', 'C', 'O', 'L', 'S', '0', '1' };
+// magic, row count, column count
+static const size_t HeaderSize = sizeof(ColumnMagic) + 2 * sizeof(uint64_t);
+
+//----------------- ColumnTable ---------------------------
+
+ColumnTable::ColumnTable(const Table &table) : rowCount(table.size()), columnCount(table.empty() ? 0 : table[0].size()),
+    owned(rowCount * columnCount), cells(owned.data()), mapped(nullptr), mappedSize(0)
+{
+    for ( size_t row = 0; row < rowCount; row++ )
+        for ( size_t col = 0; col < columnCount; col++ )
+            owned[col * rowCount + row] = table[row][col];
+}
+
+ColumnTable::ColumnTable(ColumnTable &&other) : rowCount(0), columnCount(0), cells(nullptr), mapped(nullptr), mappedSize(0)
+{
+    *this = move(other);
+}
+
+ColumnTable& ColumnTable::operator=(ColumnTable &&other)
+{
+    // moving a vector keeps its buffer, so cells stays valid
+    swap(rowCount, other.rowCount);
+    swap(columnCount, other.columnCount);
+    swap(owned, other.owned);
+    swap(cells, other.cells);
+    swap(mapped, other.mapped);
+    swap(mappedSize, other.mappedSize);
+    return *this;
+}
+
+ColumnTable::~ColumnTable()
+{
+    if ( mapped )
+        munmap(mapped, mappedSize);
+}
+
+ColumnTable ColumnTable::map(const string &fileName)
+{
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if ( fd < 0 )
+        throw runtime_error("cannot open " + fileName + ": " + strerror(errno));
+    struct stat info;
+    if ( fstat(fd, &info) != 0 || size_t(info.st_size) < HeaderSize )
+    {
+        close(fd);
+        throw runtime_error(fileName + " is not a column file");
+    }
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( data == MAP_FAILED )
+        throw runtime_error("cannot map " + fileName + ": " + strerror(errno));
+    ColumnTable t;
+    t.mapped = data;
+    t.mappedSize = info.st_size;
+    const char *header = static_cast<const char*>(data);
+    memcpy(&t.rowCount, header + sizeof(ColumnMagic), sizeof(uint64_t));
+    memcpy(&t.columnCount, header + sizeof(ColumnMagic) + sizeof(uint64_t), sizeof(uint64_t));
+    if ( memcmp(header, ColumnMagic, sizeof(ColumnMagic)) != 0
+        || t.mappedSize != HeaderSize + t.rowCount * t.columnCount * sizeof(size_t) )
+        throw runtime_error(fileName + " is not a column file");
+    t.cells = reinterpret_cast<const size_t*>(header + HeaderSize);
+    return t;
+}
+
+size_t ColumnTable::rows() const
+{
+    return rowCount;
+}
+
+size_t ColumnTable::columns() const
+{
+    return columnCount;
+}
+
+span<const size_t> ColumnTable::column(size_t col) const
+{
+    return span<const size_t>(cells + col * rowCount, rowCount);
+}
+
+//----------------- ColumnFileWriter ----------------------
+
+ColumnFileWriter::ColumnFileWriter(const string &fileName, size_t rowCount, size_t columnCount)
+    : fileName(fileName), rowCount(rowCount), columnCount(columnCount), written(0)
+{
+    fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if ( fd < 0 )
+        throw runtime_error("cannot create " + fileName + ": " + strerror(errno));
+    char header[HeaderSize];
+    const uint64_t counts[2] = { rowCount, columnCount };
+    memcpy(header, ColumnMagic, sizeof(ColumnMagic));
+    memcpy(header + sizeof(ColumnMagic), counts, sizeof(counts));
+    if ( write(fd, header, HeaderSize) != ssize_t(HeaderSize)
+        || ftruncate(fd, HeaderSize + rowCount * columnCount * sizeof(size_t)) != 0 )
+        throw runtime_error("cannot write " + fileName + ": " + strerror(errno));
+}
+
+ColumnFileWriter::~ColumnFileWriter()
+{
+    if ( fd >= 0 )
+        ::close(fd);
+}
+
+void ColumnFileWriter::append(const Table &rows)
+{
+    if ( written + rows.size() > rowCount )
+        throw runtime_error("too many rows for " + fileName);
+    vector<size_t> slice(rows.size());
+    for ( size_t col = 0; col < columnCount; col++ )
+    {
+        for ( size_t row = 0; row < rows.size(); row++ )
+        {
+            if ( rows[row].size() != columnCount )
+                throw runtime_error("expected " + to_string(columnCount) + " columns, found " + to_string(rows[row].size()));
+            slice[row] = rows[row][col];
+        }
+        const size_t bytes = slice.size() * sizeof(size_t);
+        const off_t offset = HeaderSize + (col * rowCount + written) * sizeof(size_t);
+        if ( pwrite(fd, slice.data(), bytes, offset) != ssize_t(bytes) )
+            throw runtime_error("cannot write " + fileName + ": " + strerror(errno));
+    }
+    written += rows.size();
+}
+
+void ColumnFileWriter::close()
+{
+    if ( written != rowCount )
+        throw runtime_error("expected " + to_string(rowCount) + " rows for " + fileName + ", got " + to_string(written));
+    if ( ::close(fd) != 0 )
+        throw runtime_error("cannot write " + fileName + ": " + strerror(errno));
+    fd = -1;
+}
@@ -0,0 +1,53 @@
+#ifndef COLUMN_TABLE_H
+#define COLUMN_TABLE_H
+
+#include <span>
+#include <string>
+#include "AgreeSetTypes.h"
+
+/**
+ * column-major table, so that passes over a few columns read contiguous memory
+ * either a copy of a row-major table, or memory-mapped from a column file
+ * column file: magic string, row count and column count (64 bit each), followed by all cells column by column
+ */
+class ColumnTable
+{
+    size_t rowCount, columnCount;
+    std::vector<size_t> owned;
+    // start of first column, within owned or mapped
+    const size_t *cells;
+    void *mapped;
+    size_t mappedSize;
+public:
+    ColumnTable(const Table &table = Table());
+    ColumnTable(const ColumnTable&) = delete;
+    ColumnTable(ColumnTable &&other);
+    ColumnTable& operator=(ColumnTable &&other);
+    ~ColumnTable();
+    // memory-maps column file, throws runtime_error on failure
+    static ColumnTable map(const std::string &fileName);
+
+    size_t rows() const;
+    size_t columns() const;
+    std::span<const size_t> column(size_t col) const;
+};
+
+/**
+ * writes a column file from rows appended in batches, so that tables larger than memory can be converted
+ * total number of rows must be known in advance, throws runtime_error on failure
+ */
+class ColumnFileWriter
+{
+    const std::string fileName;
+    const size_t rowCount, columnCount;
+    size_t written;
+    int fd;
+public:
+    ColumnFileWriter(const std::string &fileName, size_t rowCount, size_t columnCount);
+    ~ColumnFileWriter();
+    void append(const Table &rows);
+    // checks that all rows were written and closes file
+    void close();
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include <boost/log/trivial.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/program_options.hpp>
+#include <iostream>
+
+#include "CSVUtil.h"
+#include "ColumnTable.h"
+
+using namespace std;
+namespace po = boost::program_options;
+
+int main(int argc, char *argv[])
+{
+    string input, output;
+    size_t chunkMB = 64;
+    // extract command-line arguments
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "show options (this)")
+            ("input,i", po::value<string>(), "CSV file to read")
+            ("output,o", po::value<string>(), "column file to write")
+            ("chunk,c", po::value<size_t>(), "MB of CSV parsed at a time (default: 64)")
+        ;
+        po::positional_options_description pos;
+        pos.add("input", 1);
+        pos.add("output", 1);
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+        po::notify(vm);
+
+        if ( vm.count("help") || !vm.count("input") || !vm.count("output") )
+        {
+            cout << "usage: columnizer input.csv output.cols\n" << desc << endl;
+            return vm.count("help") ? 0 : 1;
+        }
+        input = vm["input"].as<string>();
+        output = vm["output"].as<string>();
+        if ( input == "-" )
+            throw po::error("input is read twice and cannot be stdin");
+        if ( vm.count("chunk") )
+            chunkMB = vm["chunk"].as<size_t>();
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+    boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::warning );
+
+    // first pass determines table size, second pass writes columns - memory use is bounded by chunk size
+    try {
+        const size_t chunkBytes = chunkMB << 20;
+        size_t rows = 0, columns = 0;
+        read_csv_chunks(input, chunkBytes, [&](Table &t) {
+            if ( rows == 0 && !t.empty() )
+                columns = t[0].size();
+            rows += t.size();
+        });
+        ColumnFileWriter writer(output, rows, columns);
+        read_csv_chunks(input, chunkBytes, [&writer](Table &t) { writer.append(t); });
+        writer.close();
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
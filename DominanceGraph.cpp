@@ -42,11 +42,22 @@ NodeID DominanceGraph::findDominated(std::vector<NodeID> *dominators)
 
 DominanceGraph::DominanceGraph(const InformativeGraph &g) : InformativeGraph(g)
 {
+    // bulk-load tries, matching updateCertain and updatePossible
+    std::vector<std::pair<NodeID,std::vector<AgreeSetID>>> certainSets, possibleSets;
     for ( NodeID node = 0; node < nodeCount(); node++ )
     {
-        updateCertain(node);
-        updatePossible(node);
+        std::vector<AgreeSetID> c = getCertainAgreeSets(node);
+        if ( !c.empty() )
+            certainSets.push_back(std::make_pair(node, std::move(c)));
+        std::vector<AgreeSetID> p = getPossibleAgreeSets(node);
+        if ( !p.empty() && !picked(node) )
+        {
+            dominated.insert(node);
+            possibleSets.push_back(std::make_pair(node, std::move(p)));
+        }
     }
+    certain = DominanceIndex(std::move(certainSets));
+    possible = DominanceIndex(std::move(possibleSets));
     // dominance checks require possible & certain to be up-to-date
     for ( NodeID node = 0; node < nodeCount(); node++ )
         if ( certain.contains(node) )
@@ -71,7 +82,7 @@ void DominanceGraph::pickNode(NodeID node, std::unordered_set<NodeID> *updated)
     // no need to update certain, as picked node cannot have certain agree sets
     updatePossible(node);
     // neighbors need to update certain agree sets
-    for ( NodeID neighbor : getNeighbors(node) )
+    for ( NodeID neighbor : neighbors(node) )
     {
         // avoid updating twice
         if ( updated->count(neighbor) == 0 )
@@ -99,19 +110,17 @@ bool DominanceGraph::isDominated(NodeID node, std::vector<NodeID> *dominators) c
 {
     if ( degree(node) == 0 || picked(node) )
         return false;
+    // possible matches the graph's labels, so take them from there rather than from the index
+    const std::vector<AgreeSetID> possibleSets = getPossibleAgreeSets(node);
     if ( dominators == nullptr )
-    {
-        std::vector<NodeID> dom = certain.findSupersets(possible.at(node));
-        return !dom.empty() && !(dom.size() == 1 && dom[0] == node);
-    }
-    else
-    {
-        dominators->clear();
-        for ( NodeID dominator : certain.findSupersets(possible.at(node)) )
-            if ( dominator != node )
-                dominators->push_back(dominator);
-        return !dominators->empty();
-    }
+        return certain.hasSuperset(possibleSets, node);
+    dominators->clear();
+    certain.visitSupersets(possibleSets, [node,dominators](NodeID dominator) {
+        if ( dominator != node )
+            dominators->push_back(dominator);
+        return true;
+    });
+    return !dominators->empty();
 }
 
 std::vector<NodeID> DominanceGraph::getDominated(NodeID node) const
@@ -119,27 +128,34 @@ std::vector<NodeID> DominanceGraph::getDominated(NodeID node) const
     if ( !certain.contains(node) )
         return std::vector<NodeID>(0);
     std::vector<NodeID> result;
-    for ( NodeID dominated : possible.findSubsets(certain.at(node)) )
+    possible.visitSubsets(getCertainAgreeSets(node), [this,node,&result](NodeID dominated) {
         if ( !picked(dominated) && dominated != node )
             result.push_back(dominated);
+        return true;
+    });
     return result;
 }
 
 void DominanceGraph::removeAllDominated(std::unordered_set<NodeID> *updated)
 {
-    std::vector<NodeID> dominators;
-    NodeID dominatedNode = findDominated(&dominators);
+    // dominators are only needed for logging, so only collect them if logged
+    auto dominatorsOf = [this](NodeID node) {
+        std::vector<NodeID> dominators;
+        isDominated(node, &dominators);
+        return dominators;
+    };
+    NodeID dominatedNode = findDominated();
     while ( dominatedNode != NaNode )
     {
         if ( updated != nullptr )
         {
-            for ( NodeID neighbor : getNeighbors(dominatedNode) )
+            for ( NodeID neighbor : neighbors(dominatedNode) )
                 updated->insert(neighbor);
             updated->insert(dominatedNode);
         }
-        BOOST_LOG_TRIVIAL(info) << "removing node " << dominatedNode << " dominated by " << dominators;
+        BOOST_LOG_TRIVIAL(info) << "removing node " << dominatedNode << " dominated by " << dominatorsOf(dominatedNode);
         removeNode(dominatedNode);
-        dominatedNode = findDominated(&dominators);
+        dominatedNode = findDominated();
     }
 }
 
@@ -156,7 +172,7 @@ std::vector<NodeID> DominanceGraph::prune(std::unordered_set<NodeID> *updated)
     do {
         propagateUpdates();
         // removing nodes can make nodes newly forced
-        std::vector<NodeID> forced = getForced();
+        std::vector<NodeID> forced = getNewlyForced();
         for ( NodeID node : forced )
             if ( !picked(node) )
             {
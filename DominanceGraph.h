@@ -2,7 +2,14 @@
 #define DOMINANCE_GRAPH_H
 
 #include "InformativeGraph.h"
+// index used for subset/superset checks, chosen at compile time
+#ifdef SIGNATURE_INDEX
+#include "SignatureIndex.h"
+typedef SignatureIndex<NodeID,AgreeSetID> DominanceIndex;
+#else
 #include "OrderedTrie.h"
+typedef OrderedTrie<NodeID,AgreeSetID> DominanceIndex;
+#endif
 
 /**
  * extends InformativeGraph by tracking dominance information
@@ -13,7 +20,7 @@ private:
     static const NodeID NaNode = 999999999;
 
     // store certain and possible agree sets for efficient subset/superset checks
-    OrderedTrie<NodeID,AgreeSetID> certain, possible;
+    DominanceIndex certain, possible;
     // all *potentially* dominated nodes
     std::unordered_set<NodeID> dominated;
 
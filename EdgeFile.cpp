@@ -0,0 +1,159 @@
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "EdgeFile.h"
+
+using namespace std;
+
+static const char EdgeMagic[8] = { 'A', 'S', 'E', 'D', 'G', 'E', 'S', '1' };
+// magic, node count, label count, edge count, flags
+static const size_t HeaderSize = sizeof(EdgeMagic) + 4 * sizeof(uint64_t);
+static const uint64_t DeltaFlag = 1;
+
+//----------------- EdgeFileWriter ------------------------
+
+EdgeFileWriter::EdgeFileWriter(const string &fileName, bool delta) : fileName(fileName), out(fileName, ios::binary | ios::trunc), lastV(0), lastW(0)
+{
+    if ( !out )
+        throw runtime_error("cannot write " + fileName);
+    header.delta = delta;
+    // counts are not known yet
+    writeHeader();
+}
+
+void EdgeFileWriter::writeHeader()
+{
+    const uint64_t values[4] = { header.nodeCount, header.labelCount, header.edgeCount, header.delta ? DeltaFlag : 0 };
+    out.write(EdgeMagic, sizeof(EdgeMagic));
+    out.write(reinterpret_cast<const char*>(values), sizeof(values));
+}
+
+void EdgeFileWriter::writeVarint(uint64_t value)
+{
+    char bytes[10];
+    size_t length = 0;
+    while ( value >= 0x80 )
+    {
+        bytes[length++] = char(value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = char(value);
+    out.write(bytes, length);
+}
+
+void EdgeFileWriter::add(NodeID v, NodeID w, AgreeSetID label)
+{
+    if ( header.delta )
+    {
+        // w is encoded relative to previous w for the same v, and relative to v otherwise
+        if ( v < lastV || w <= v || (v == lastV && header.edgeCount > 0 && w < lastW) )
+            throw runtime_error("edges must be sorted for delta encoding");
+        writeVarint(v - lastV);
+        writeVarint(v == lastV && header.edgeCount > 0 ? w - lastW : w - v);
+        writeVarint(label);
+    }
+    else
+    {
+        const uint32_t values[3] = { v, w, label };
+        out.write(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+    lastV = v;
+    lastW = w;
+    header.nodeCount = max<uint64_t>(header.nodeCount, max(v, w) + uint64_t(1));
+    header.labelCount = max<uint64_t>(header.labelCount, label + uint64_t(1));
+    header.edgeCount++;
+}
+
+void EdgeFileWriter::close()
+{
+    out.seekp(0);
+    writeHeader();
+    out.close();
+    if ( !out )
+        throw runtime_error("cannot write " + fileName);
+}
+
+//----------------- EdgeFileReader ------------------------
+
+EdgeFileReader::EdgeFileReader(const string &fileName) : mapped(nullptr), mappedSize(0)
+{
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if ( fd < 0 )
+        throw runtime_error("cannot open " + fileName + ": " + strerror(errno));
+    struct stat info;
+    if ( fstat(fd, &info) != 0 || size_t(info.st_size) < HeaderSize )
+    {
+        close(fd);
+        throw runtime_error(fileName + " is not an edge file");
+    }
+    mappedSize = info.st_size;
+    mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if ( mapped == MAP_FAILED )
+        throw runtime_error("cannot map " + fileName + ": " + strerror(errno));
+    // edges are read once, front to back
+    madvise(mapped, mappedSize, MADV_SEQUENTIAL);
+    const char *data = static_cast<const char*>(mapped);
+    uint64_t values[4];
+    memcpy(values, data + sizeof(EdgeMagic), sizeof(values));
+    header.nodeCount = values[0];
+    header.labelCount = values[1];
+    header.edgeCount = values[2];
+    header.delta = values[3] & DeltaFlag;
+    if ( memcmp(data, EdgeMagic, sizeof(EdgeMagic)) != 0
+        || (!header.delta && mappedSize != HeaderSize + header.edgeCount * 3 * sizeof(uint32_t)) )
+    {
+        munmap(mapped, mappedSize);
+        throw runtime_error(fileName + " is not an edge file");
+    }
+}
+
+EdgeFileReader::~EdgeFileReader()
+{
+    munmap(mapped, mappedSize);
+}
+
+const EdgeFileHeader& EdgeFileReader::getHeader() const
+{
+    return header;
+}
+
+void EdgeFileReader::visit(const function<void(NodeID, NodeID, AgreeSetID)> &visit) const
+{
+    const unsigned char *pos = static_cast<const unsigned char*>(mapped) + HeaderSize;
+    const unsigned char *end = static_cast<const unsigned char*>(mapped) + mappedSize;
+    if ( !header.delta )
+    {
+        for ( uint64_t i = 0; i < header.edgeCount; i++, pos += 3 * sizeof(uint32_t) )
+        {
+            uint32_t values[3];
+            memcpy(values, pos, sizeof(values));
+            visit(values[0], values[1], values[2]);
+        }
+        return;
+    }
+    auto readVarint = [&pos, end]() {
+        uint64_t value = 0;
+        for ( unsigned shift = 0; ; shift += 7 )
+        {
+            if ( pos == end || shift > 63 )
+                throw runtime_error("corrupt edge file");
+            const unsigned char byte = *pos++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if ( byte < 0x80 )
+                return value;
+        }
+    };
+    NodeID v = 0, w = 0;
+    for ( uint64_t i = 0; i < header.edgeCount; i++ )
+    {
+        const uint64_t dv = readVarint();
+        v += dv;
+        w = (dv == 0 && i > 0 ? w : v) + readVarint();
+        visit(v, w, readVarint());
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef EDGE_FILE_H
+#define EDGE_FILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include "InformativeGraph.h"
+
+/**
+ * binary edge list, as an alternative to "v w label" text lines
+ * header: magic string, node count, label count, edge count and flags (64 bit each), followed by the edges;
+ * edges are stored as three 32-bit values each, or delta-encoded as varints if edges are sorted
+ */
+struct EdgeFileHeader
+{
+    uint64_t nodeCount = 0, labelCount = 0, edgeCount = 0;
+    bool delta = false;
+};
+
+// writes edge file, throws runtime_error on failure
+class EdgeFileWriter
+{
+    const std::string fileName;
+    std::ofstream out;
+    EdgeFileHeader header;
+    NodeID lastV, lastW;
+    void writeHeader();
+    void writeVarint(uint64_t value);
+public:
+    // delta encoding requires edges to be added in lexicographic order, with v < w
+    EdgeFileWriter(const std::string &fileName, bool delta = false);
+    void add(NodeID v, NodeID w, AgreeSetID label);
+    // writes final counts to header and closes file
+    void close();
+};
+
+// memory-maps edge file, throws runtime_error on failure
+class EdgeFileReader
+{
+    EdgeFileHeader header;
+    void *mapped;
+    size_t mappedSize;
+public:
+    EdgeFileReader(const std::string &fileName);
+    EdgeFileReader(const EdgeFileReader&) = delete;
+    ~EdgeFileReader();
+    const EdgeFileHeader& getHeader() const;
+    // calls visit for each edge, in the order written
+    void visit(const std::function<void(NodeID, NodeID, AgreeSetID)> &visit) const;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include <numeric>
+#include <boost/log/trivial.hpp>
+
+#include "HittingSet.h"
+#include "BoostUtil.h"
+#include "VectorUtil.h"
+
+using namespace std;
+
+//----------------- BergeHittingSets ----------------------
+
+BergeHittingSets::BergeHittingSets(size_t columns) : edges(0), trans(1, AttributeSet(columns))
+{
+    transIndex.insert(trans.back());
+}
+
+void BergeHittingSets::addEdge(const AttributeSet &edge)
+{
+    edges++;
+    vector<AttributeSet> newTrans;
+    AttributeSetTrie newTransIndex;
+    size_t next = 0;
+    while ( next < trans.size() )
+    {
+        AttributeSet &t = trans[next];
+        if ( !t.intersects(edge) )
+        {
+            // extend to new transversal values
+            for ( size_t att = edge.find_first(); att != AttributeSet::npos; att = edge.find_next(att) )
+            {
+                AttributeSet tExtended(t);
+                tExtended.set(att);
+                if ( newTransIndex.insert(tExtended) )
+                    newTrans.push_back(tExtended);
+            }
+            // remove from trans
+            transIndex.erase(t);
+            t = trans.back();
+            trans.pop_back();
+        }
+        else
+            next++;
+    }
+    // minimize transversal - only new transversals need to be checked
+    // checking against all new ones is fine, as supersets of discarded ones get discarded too
+    for ( const AttributeSet &tNew : newTrans )
+        if ( !transIndex.containsSubset(tNew) && !newTransIndex.containsStrictSubset(tNew) )
+            trans.push_back(tNew);
+    for ( size_t i = transIndex.size(); i < trans.size(); i++ )
+        transIndex.insert(trans[i]);
+}
+
+void BergeHittingSets::run(const function<void(const AttributeSet&)> &visit)
+{
+    while ( !trans.empty() )
+    {
+        const AttributeSet x = trans.back();
+        const size_t edgesBefore = edges;
+        visit(x);
+        // x is no longer a transversal if an edge was added, otherwise it is final
+        if ( edges == edgesBefore )
+        {
+            transIndex.erase(x);
+            trans.pop_back();
+        }
+        BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << ": trans = " << trans;
+    }
+}
+
+size_t BergeHittingSets::edgeCount() const
+{
+    return edges;
+}
+
+//----------------- MMCSHittingSets -----------------------
+
+MMCSHittingSets::MMCSHittingSets(size_t columns) : columns(columns)
+{
+}
+
+void MMCSHittingSets::addEdge(const AttributeSet &edge)
+{
+    edges.push_back(edge);
+}
+
+/**
+ * s = current partial transversal, cand = attributes that may still be added, uncov = uncovered edges
+ * crit[u] for u in s = edges hit by u only; every u in s must keep a critical edge for s to be minimal
+ * only the first passEdges edges are used for branching
+ */
+void MMCSHittingSets::search(AttributeSet &s, AttributeSet &cand, const vector<uint32_t> &uncov, vector<vector<uint32_t>> &crit,
+                             size_t passEdges, const function<void(const AttributeSet&)> &visit)
+{
+    if ( uncov.empty() )
+    {
+        // edges added during this pass need not be hit - a superset will be found in the next pass
+        for ( size_t e = passEdges; e < edges.size(); e++ )
+            if ( !s.intersects(edges[e]) )
+                return;
+        visit(s);
+        return;
+    }
+    // branch on uncovered edge with fewest candidates
+    AttributeSet branch(columns), scratch(columns);
+    size_t branchCount = columns + 1;
+    for ( uint32_t e : uncov )
+    {
+        scratch = edges[e];
+        scratch &= cand;
+        const size_t count = scratch.count();
+        if ( count < branchCount )
+        {
+            branch.swap(scratch);
+            branchCount = count;
+            if ( count == 0 )
+                return;
+        }
+    }
+    cand -= branch;
+    vector<uint32_t> newUncov;
+    vector<pair<size_t, vector<uint32_t>>> saved;
+    for ( size_t v = branch.find_first(); v != AttributeSet::npos; v = branch.find_next(v) )
+    {
+        // edges hit by v become critical for v unless already covered
+        newUncov.clear();
+        for ( uint32_t e : uncov )
+            (edges[e][v] ? crit[v] : newUncov).push_back(e);
+        // edges hit by v are no longer critical for other members of s
+        bool minimal = true;
+        for ( size_t u = s.find_first(); u != AttributeSet::npos && minimal; u = s.find_next(u) )
+        {
+            vector<uint32_t> kept;
+            for ( uint32_t e : crit[u] )
+                if ( !edges[e][v] )
+                    kept.push_back(e);
+            if ( kept.size() < crit[u].size() )
+            {
+                minimal = !kept.empty();
+                saved.emplace_back(u, move(crit[u]));
+                crit[u] = move(kept);
+            }
+        }
+        if ( minimal )
+        {
+            s.set(v);
+            search(s, cand, newUncov, crit, passEdges, visit);
+            s.reset(v);
+        }
+        // undo changes
+        for ( pair<size_t, vector<uint32_t>> &entry : saved )
+            crit[entry.first] = move(entry.second);
+        saved.clear();
+        crit[v].clear();
+        cand.set(v);
+    }
+}
+
+void MMCSHittingSets::run(const function<void(const AttributeSet&)> &visit)
+{
+    size_t passEdges, passes = 0;
+    do
+    {
+        passEdges = edges.size();
+        passes++;
+        AttributeSet s(columns), cand(columns);
+        cand.flip();
+        vector<uint32_t> uncov(passEdges);
+        iota(uncov.begin(), uncov.end(), 0);
+        vector<vector<uint32_t>> crit(columns);
+        search(s, cand, uncov, crit, passEdges, visit);
+    } while ( edges.size() > passEdges );
+    BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << ": " << edges.size() << " edges, " << passes << " passes";
+}
+
+size_t MMCSHittingSets::edgeCount() const
+{
+    return edges.size();
+}
@@ -0,0 +1,61 @@
+#ifndef HITTING_SET_H
+#define HITTING_SET_H
+
+#include <functional>
+#include "AgreeSetTypes.h"
+#include "AttributeSetTrie.h"
+
+/**
+ * enumerates minimal hitting sets (transversals) of a hypergraph that may grow during enumeration
+ * visit(t) is called for minimal transversals t of the current edges, and may add edges via addEdge;
+ * it must either add an edge not hit by t, or accept t as final
+ * run returns once every minimal transversal of the final hypergraph has been visited and accepted
+ */
+class HittingSetEngine
+{
+public:
+    virtual ~HittingSetEngine() {}
+    virtual void addEdge(const AttributeSet &edge) = 0;
+    virtual void run(const std::function<void(const AttributeSet&)> &visit) = 0;
+    // number of edges added so far
+    virtual size_t edgeCount() const = 0;
+};
+
+/**
+ * Berge-style incremental computation: keeps all minimal transversals of the current edges,
+ * and extends & minimizes them whenever an edge is added
+ */
+class BergeHittingSets : public HittingSetEngine
+{
+    size_t edges;
+    // unvisited minimal transversals
+    std::vector<AttributeSet> trans;
+    AttributeSetTrie transIndex; // same sets as trans, for fast subset checks
+public:
+    BergeHittingSets(size_t columns);
+    void addEdge(const AttributeSet &edge) override;
+    void run(const std::function<void(const AttributeSet&)> &visit) override;
+    size_t edgeCount() const override;
+};
+
+/**
+ * depth-first enumeration following MMCS (Murakami & Uno, "Efficient algorithms for dualizing large-scale
+ * hypergraphs", 2014); memory is linear in the number of edges times search depth, as transversals are not stored
+ * edges added during a pass are checked when a transversal is reached, and passes are repeated until no edges
+ * are added - transversals accepted in an earlier pass are visited again, so visit should be cheap for them
+ */
+class MMCSHittingSets : public HittingSetEngine
+{
+    const size_t columns;
+    std::vector<AttributeSet> edges;
+
+    void search(AttributeSet &s, AttributeSet &cand, const std::vector<uint32_t> &uncov, std::vector<std::vector<uint32_t>> &crit,
+                size_t passEdges, const std::function<void(const AttributeSet&)> &visit);
+public:
+    MMCSHittingSets(size_t columns);
+    void addEdge(const AttributeSet &edge) override;
+    void run(const std::function<void(const AttributeSet&)> &visit) override;
+    size_t edgeCount() const override;
+};
+
+#endif
@@ -1,3 +1,4 @@
+#include <set>
 #include <unordered_set>
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
@@ -11,62 +12,286 @@ static std::pair<NodeID,NodeID> ordered(NodeID v, NodeID w)
     return v < w ? std::pair(v,w) : std::pair(w,v);
 }
 
+void InformativeGraph::build() const
+{
+    if ( pending.empty() && offsets.size() == nodes + 1 )
+        return;
+    // edges still alive, plus edges added since
+    std::vector<std::pair<Edge,AgreeSetID>> edges;
+    edges.reserve(alive.count() / 2 + pending.size());
+    for ( NodeID v = 0; v + 1 < offsets.size(); v++ )
+        for ( size_t i = 0; i < degrees[v]; i++ )
+        {
+            const Adjacent &a = adjacent[offsets[v] + packedSlots[offsets[v] + i]];
+            if ( v < a.node )
+                edges.push_back(std::make_pair(Edge(v, a.node), a.label));
+        }
+    edges.insert(edges.end(), pending.begin(), pending.end());
+    std::vector<std::pair<Edge,AgreeSetID>>().swap(pending);
+    // neighbors
+    degrees.assign(nodes, 0);
+    for ( const std::pair<Edge,AgreeSetID> &e : edges )
+    {
+        degrees[e.first.first]++;
+        degrees[e.first.second]++;
+    }
+    offsets.assign(nodes + 1, 0);
+    for ( NodeID node = 0; node < nodes; node++ )
+        offsets[node + 1] = offsets[node] + degrees[node];
+    adjacent.resize(offsets[nodes]);
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for ( const std::pair<Edge,AgreeSetID> &e : edges )
+    {
+        adjacent[next[e.first.first]++] = Adjacent{ e.first.second, e.second };
+        adjacent[next[e.first.second]++] = Adjacent{ e.first.first, e.second };
+    }
+    for ( NodeID node = 0; node < nodes; node++ )
+    {
+        std::sort(adjacent.begin() + offsets[node], adjacent.begin() + offsets[node + 1],
+                  [](const Adjacent &a, const Adjacent &b) { return a.node < b.node; });
+        for ( size_t slot = offsets[node] + 1; slot < offsets[node + 1]; slot++ )
+            assert(adjacent[slot - 1].node != adjacent[slot].node);
+    }
+    twins.resize(adjacent.size());
+    for ( NodeID v = 0; v < nodes; v++ )
+        for ( size_t slot = offsets[v]; slot < offsets[v + 1] && adjacent[slot].node < v; slot++ )
+        {
+            const NodeID w = adjacent[slot].node;
+            const size_t twin = findAdjacent(w, v);
+            twins[slot] = twin - offsets[w];
+            twins[twin] = slot - offsets[v];
+        }
+    packed.resize(adjacent.size());
+    packedSlots.resize(adjacent.size());
+    positions.resize(adjacent.size());
+    for ( NodeID node = 0; node < nodes; node++ )
+        for ( size_t slot = offsets[node]; slot < offsets[node + 1]; slot++ )
+        {
+            packed[slot] = adjacent[slot].node;
+            packedSlots[slot] = positions[slot] = slot - offsets[node];
+        }
+    alive.resize(adjacent.size());
+    alive.set();
+    // edges by label
+    size_t labelCount = removedLabels.size();
+    for ( const std::pair<Edge,AgreeSetID> &e : edges )
+        labelCount = std::max<size_t>(labelCount, e.second + 1);
+    labelOffsets.assign(labelCount + 1, 0);
+    for ( const std::pair<Edge,AgreeSetID> &e : edges )
+        labelOffsets[e.second + 1]++;
+    for ( size_t ag = 0; ag < labelCount; ag++ )
+        labelOffsets[ag + 1] += labelOffsets[ag];
+    labelEdges.resize(edges.size());
+    labelSlots.resize(edges.size());
+    next.assign(labelOffsets.begin(), labelOffsets.end() - 1);
+    for ( NodeID v = 0; v < nodes; v++ )
+        for ( size_t slot = offsets[v]; slot < offsets[v + 1]; slot++ )
+            if ( v < adjacent[slot].node )
+            {
+                const size_t i = next[adjacent[slot].label]++;
+                labelEdges[i] = Edge(v, adjacent[slot].node);
+                labelSlots[i] = slot;
+            }
+    // labels may get edges again after removal, and label IDs without edges count as removed
+    removedLabels.resize(labelCount);
+    for ( AgreeSetID ag = 0; ag < labelCount; ag++ )
+        removedLabels[ag] = labelOffsets[ag] == labelOffsets[ag + 1];
+    // all labels may be forcing after rebuild
+    liveCounts.resize(labelCount);
+    firstLive.assign(labelOffsets.begin(), labelOffsets.end() - 1);
+    changedLabels.clear();
+    labelChanged.resize(labelCount);
+    labelChanged.reset();
+    for ( AgreeSetID ag = 0; ag < labelCount; ag++ )
+    {
+        liveCounts[ag] = labelOffsets[ag + 1] - labelOffsets[ag];
+        if ( liveCounts[ag] > 0 )
+        {
+            changedLabels.push_back(ag);
+            labelChanged.set(ag);
+        }
+    }
+    countLabels();
+}
+
+void InformativeGraph::countLabels() const
+{
+    nodeLabelOffsets.assign(nodes + 1, 0);
+    nodeLabels.clear();
+    slotLabels.resize(adjacent.size());
+    possibleSizes.assign(nodes, 0);
+    certainSizes.assign(nodes, 0);
+    for ( NodeID node = 0; node < nodes; node++ )
+    {
+        const size_t first = nodeLabels.size();
+        for ( size_t slot = offsets[node]; slot < offsets[node + 1]; slot++ )
+            nodeLabels.push_back(adjacent[slot].label);
+        std::sort(nodeLabels.begin() + first, nodeLabels.end());
+        nodeLabels.erase(std::unique(nodeLabels.begin() + first, nodeLabels.end()), nodeLabels.end());
+        nodeLabelOffsets[node + 1] = nodeLabels.size();
+        for ( size_t slot = offsets[node]; slot < offsets[node + 1]; slot++ )
+            slotLabels[slot] = std::lower_bound(nodeLabels.begin() + first, nodeLabels.end(), adjacent[slot].label)
+                - (nodeLabels.begin() + first);
+    }
+    labelCounts.assign(nodeLabels.size(), LabelCount{ 0, 0 });
+    for ( NodeID node = 0; node < nodes; node++ )
+        for ( size_t slot = offsets[node]; slot < offsets[node + 1]; slot++ )
+            if ( alive[slot] )
+            {
+                updateCount(node, slot, false, 1);
+                if ( pickedNodes[adjacent[slot].node] )
+                    updateCount(node, slot, true, 1);
+            }
+}
+
+void InformativeGraph::updateCount(NodeID node, size_t slot, bool certain, int delta) const
+{
+    LabelCount &count = labelCounts[nodeLabelOffsets[node] + slotLabels[slot]];
+    uint32_t &labelCount = certain ? count.certain : count.possible;
+    std::vector<uint32_t> &sizes = certain ? certainSizes : possibleSizes;
+    if ( labelCount == 0 )
+        sizes[node]++;
+    labelCount += delta;
+    if ( labelCount == 0 )
+        sizes[node]--;
+}
+
+size_t InformativeGraph::findAdjacent(NodeID v, NodeID w) const
+{
+    auto begin = adjacent.begin() + offsets[v], end = adjacent.begin() + offsets[v + 1];
+    auto it = std::lower_bound(begin, end, w, [](const Adjacent &a, NodeID node) { return a.node < node; });
+    return it != end && it->node == w ? it - adjacent.begin() : SIZE_MAX;
+}
+
 bool InformativeGraph::validate(std::string &msg) const
 {
+    build();
     for ( NodeID node = 0; node < nodeCount(); node++ )
-        for ( NodeID neighbor : neighbors[node] )
+        for ( NodeID neighbor : neighbors(node) )
         {
-            if ( !contains(neighbors[neighbor], node) )
+            if ( !hasEdge(neighbor, node) )
             {
                 msg = (boost::format("node %1% is missing neighbor %2%") % neighbor % node).str();
                 return false;
             }
         }
+    for ( NodeID node = 0; node < nodeCount(); node++ )
+    {
+        std::set<AgreeSetID> possibleSet, certainSet;
+        for ( NodeID neighbor : neighbors(node) )
+        {
+            possibleSet.insert(getEdgeLabel(node, neighbor));
+            if ( picked(neighbor) )
+                certainSet.insert(getEdgeLabel(node, neighbor));
+        }
+        if ( getPossibleAgreeSets(node) != std::vector<AgreeSetID>(possibleSet.begin(), possibleSet.end())
+            || getCertainAgreeSets(node) != std::vector<AgreeSetID>(certainSet.begin(), certainSet.end())
+            || getPossibleAgreeSetCount(node) != possibleSet.size() || getCertainAgreeSetCount(node) != certainSet.size() )
+        {
+            msg = (boost::format("label counts of node %1% are out of date") % node).str();
+            return false;
+        }
+    }
     return true;
 }
 
 bool InformativeGraph::hasEdge(NodeID v, NodeID w) const
 {
-    return contains(neighbors[v], w);
+    build();
+    const size_t slot = findAdjacent(v, w);
+    return slot != SIZE_MAX && alive[slot];
 }
 
 void InformativeGraph::removeEdge(NodeID v, NodeID w)
 {
-    std::erase(neighbors[v], w);
-    std::erase(neighbors[w], v);
+    build();
+    const size_t slot = findAdjacent(v, w);
+    if ( slot != SIZE_MAX && alive[slot] )
+        removeSlot(v, slot);
+}
+
+void InformativeGraph::unpack(NodeID node, size_t slot)
+{
+    // swap with last alive neighbor
+    const size_t first = offsets[node];
+    const uint32_t position = positions[slot], last = --degrees[node];
+    const uint32_t moved = packedSlots[first + last];
+    packed[first + position] = packed[first + last];
+    packedSlots[first + position] = moved;
+    positions[first + moved] = position;
+    packed[first + last] = adjacent[slot].node;
+    packedSlots[first + last] = slot - first;
+    positions[slot] = last;
+}
+
+void InformativeGraph::removeSlot(NodeID v, size_t slot)
+{
+    const NodeID w = adjacent[slot].node;
+    const size_t twin = offsets[w] + twins[slot];
+    alive.reset(slot);
+    alive.reset(twin);
+    unpack(v, slot);
+    unpack(w, twin);
+    const AgreeSetID ag = adjacent[slot].label;
+    if ( --liveCounts[ag] == 0 )
+        removedLabels.set(ag);
+    else if ( !labelChanged[ag] )
+    {
+        changedLabels.push_back(ag);
+        labelChanged.set(ag);
+    }
+    updateCount(v, slot, false, -1);
+    updateCount(w, twin, false, -1);
+    if ( picked(w) )
+        updateCount(v, slot, true, -1);
+    if ( picked(v) )
+        updateCount(w, twin, true, -1);
 }
 
 void InformativeGraph::removeAgreeSet(AgreeSetID ag, std::unordered_set<NodeID> *updated)
 {
-    for ( std::pair<Edge, AgreeSetID> keyValue : edgeLabels )
-        if ( keyValue.second == ag )
+    build();
+    if ( ag >= removedLabels.size() || removedLabels[ag] )
+        return;
+    for ( size_t i = firstLive[ag]; i < labelOffsets[ag + 1]; i++ )
+    {
+        const Edge &edge = labelEdges[i];
+        if ( alive[labelSlots[i]] )
         {
-            removeEdge(keyValue.first.first, keyValue.first.second);
+            removeSlot(edge.first, labelSlots[i]);
             if ( updated != nullptr )
             {
-                updated->insert(keyValue.first.first);
-                updated->insert(keyValue.first.second);
+                updated->insert(edge.first);
+                updated->insert(edge.second);
             }
         }
+    }
+    // all edges with this label are gone now
+    removedLabels.set(ag);
 }
 
-InformativeGraph::InformativeGraph(size_t nodeCount) : neighbors(nodeCount), pickedNodes(nodeCount)
+InformativeGraph::InformativeGraph(size_t nodeCount) : nodes(nodeCount), pickedNodes(nodeCount)
 {
 }
 
 size_t InformativeGraph::nodeCount() const
 {
-    return neighbors.size();
+    return nodes;
 }
 
 size_t InformativeGraph::degree(NodeID node) const
 {
-    return neighbors[node].size();
+    build();
+    return degrees[node];
 }
 
 AgreeSetID InformativeGraph::getEdgeLabel(NodeID v, NodeID w) const
 {
-    return edgeLabels.at(ordered(v,w));
+    build();
+    const size_t slot = findAdjacent(v, w);
+    if ( slot == SIZE_MAX )
+        throw std::out_of_range((boost::format("no edge between %1% and %2%") % v % w).str());
+    return adjacent[slot].label;
 }
 
 bool InformativeGraph::picked(NodeID node) const
@@ -74,28 +299,43 @@ bool InformativeGraph::picked(NodeID node) const
     return pickedNodes[node];
 }
 
+void InformativeGraph::reserve(size_t nodeCount, size_t edgeCount)
+{
+    if ( nodes < nodeCount )
+    {
+        nodes = nodeCount;
+        pickedNodes.resize(nodeCount);
+    }
+    pending.reserve(edgeCount);
+}
+
 void InformativeGraph::addEdge(NodeID v, NodeID w, AgreeSetID ag)
 {
-    // store edge label
     Edge edge = ordered(v,w);
-    assert(edgeLabels.count(edge) == 0);
-    edgeLabels[edge] = ag;
+    pending.push_back(std::make_pair(edge, ag));
     // resize graph if needed
-    if ( neighbors.size() <= edge.second )
+    if ( nodes <= edge.second )
     {
-        neighbors.resize(edge.second + 1);
-        pickedNodes.resize(edge.second + 1);
+        nodes = edge.second + 1;
+        pickedNodes.resize(nodes);
     }
-    // insert neighbors
-    neighbors[v].push_back(w);
-    neighbors[w].push_back(v);
 }
 
 void InformativeGraph::pickNode(NodeID node, std::unordered_set<NodeID> *updated)
 {
     assert(!picked(node));
     BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << '(' << node << ')';
+    build();
     pickedNodes[node] = true;
+    // edges to node become certain for its neighbors, edges to picked neighbors for node
+    for ( size_t i = 0; i < degrees[node]; i++ )
+    {
+        const size_t slot = offsets[node] + packedSlots[offsets[node] + i];
+        const NodeID neighbor = adjacent[slot].node;
+        updateCount(neighbor, offsets[neighbor] + twins[slot], true, 1);
+        if ( picked(neighbor) )
+            updateCount(node, slot, true, 1);
+    }
     // automatically eliminate edges that are no longer needed
     for ( AgreeSetID ag : getCertainAgreeSets(node) )
         removeAgreeSet(ag, updated);
@@ -105,84 +345,99 @@ void InformativeGraph::removeNode(NodeID node)
 {
     assert(!picked(node));
     BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << '(' << node << ')';
-    std::vector<NodeID> neighborsOfNode = neighbors[node];
-    for ( NodeID neighbor : neighborsOfNode )
-        removeEdge(node, neighbor);
-    assert(degree(node) == 0);
+    build();
+    while ( degrees[node] > 0 )
+        removeSlot(node, offsets[node] + packedSlots[offsets[node] + degrees[node] - 1]);
 }
 
 std::vector<NodeID> InformativeGraph::getNeighbors(NodeID node) const
 {
-    return neighbors[node];
+    const std::span<const NodeID> result = neighbors(node);
+    return std::vector<NodeID>(result.begin(), result.end());
+}
+
+std::span<const NodeID> InformativeGraph::neighbors(NodeID node) const
+{
+    build();
+    return std::span<const NodeID>(packed.data() + offsets[node], degrees[node]);
 }
 
 std::vector<AgreeSetID> InformativeGraph::getPossibleAgreeSets(NodeID node) const
 {
-    std::unordered_set<AgreeSetID> s;
-    for ( NodeID neighbor : neighbors[node] )
-        s.insert(getEdgeLabel(node, neighbor));
-    std::vector<AgreeSetID> result(s.begin(), s.end());
-    sort(result.begin(), result.end());
+    build();
+    std::vector<AgreeSetID> result;
+    result.reserve(possibleSizes[node]);
+    for ( size_t i = nodeLabelOffsets[node]; i < nodeLabelOffsets[node + 1]; i++ )
+        if ( labelCounts[i].possible > 0 )
+            result.push_back(nodeLabels[i]);
     return result;
 }
 
 std::vector<AgreeSetID> InformativeGraph::getCertainAgreeSets(NodeID node) const
 {
-    std::unordered_set<AgreeSetID> s;
-    for ( NodeID neighbor : neighbors[node] )
-        if ( picked(neighbor) )
-            s.insert(getEdgeLabel(node, neighbor));
-    std::vector<AgreeSetID> result(s.begin(), s.end());
-    sort(result.begin(), result.end());
+    build();
+    std::vector<AgreeSetID> result;
+    result.reserve(certainSizes[node]);
+    for ( size_t i = nodeLabelOffsets[node]; i < nodeLabelOffsets[node + 1]; i++ )
+        if ( labelCounts[i].certain > 0 )
+            result.push_back(nodeLabels[i]);
     return result;
 }
 
+size_t InformativeGraph::getPossibleAgreeSetCount(NodeID node) const
+{
+    build();
+    return possibleSizes[node];
+}
+
+size_t InformativeGraph::getCertainAgreeSetCount(NodeID node) const
+{
+    build();
+    return certainSizes[node];
+}
+
+void InformativeGraph::addForced(AgreeSetID ag, std::vector<NodeID> &forced) const
+{
+    if ( removedLabels[ag] )
+        return;
+    // edges are only removed between rebuilds, so first alive edge only moves forward
+    size_t &first = firstLive[ag];
+    while ( !alive[labelSlots[first]] )
+        first++;
+    // forced nodes must be endpoints of every alive edge, including the first one
+    for ( NodeID node : { labelEdges[first].first, labelEdges[first].second } )
+    {
+        auto begin = nodeLabels.begin() + nodeLabelOffsets[node], end = nodeLabels.begin() + nodeLabelOffsets[node + 1];
+        auto it = std::lower_bound(begin, end, ag);
+        if ( labelCounts[it - nodeLabels.begin()].possible == liveCounts[ag] )
+            forced.push_back(node);
+    }
+}
+
 std::vector<NodeID> InformativeGraph::getForced() const
 {
-    // organize edges by agree set and compute intersections
-    static const std::vector<NodeID> NotVisited = { 999999999, 999999999 };
-    std::vector<std::vector<NodeID>> forcedByAgreeSet;
-    for ( std::pair<Edge,AgreeSetID> keyValue : edgeLabels )
+    build();
+    std::vector<NodeID> forced;
+    for ( AgreeSetID ag = 0; ag < removedLabels.size(); ag++ )
+        addForced(ag, forced);
+    std::sort(forced.begin(), forced.end());
+    forced.erase(std::unique(forced.begin(), forced.end()), forced.end());
+    return forced;
+}
+
+std::vector<NodeID> InformativeGraph::getNewlyForced()
+{
+    build();
+    std::vector<NodeID> forced;
+    for ( AgreeSetID ag : changedLabels )
     {
-        // skip edges already removed
-        if ( !hasEdge(keyValue.first.first, keyValue.first.second) )
-            continue;
-        // resize vector if needed
-        if ( keyValue.second >= forcedByAgreeSet.size() )
-            forcedByAgreeSet.resize(keyValue.second + 1, NotVisited);
-        // intersect with new edge
-        std::vector<NodeID> &forced = forcedByAgreeSet[keyValue.second];
-        const Edge &e = keyValue.first;
-        if ( forced == NotVisited )
-        {
-            forced[0] = e.first;
-            forced[1] = e.second;
-        }
-        else if ( forced.size() == 2 )
-        {
-            // can have at most one overlap
-            if ( forced[0] == e.first || forced[0] == e.second )
-                forced.resize(1);
-            else if ( forced[1] == e.first || forced[1] == e.second )
-            {
-                forced[0] = forced[1];
-                forced.resize(1);
-            }
-            else
-                forced.resize(0);
-        }
-        else if ( forced.size() == 1 )
-        {
-            if ( forced[0] != e.first && forced[0] != e.second )
-                forced.resize(0);
-        }
+        addForced(ag, forced);
+        labelChanged.reset(ag);
     }
-    // combine into single vector
-    std::unordered_set<NodeID> forcedNodes;
-    for ( const std::vector<NodeID> &forced : forcedByAgreeSet )
-        if ( forced != NotVisited )
-            forcedNodes.insert(forced.begin(), forced.end());
-    return std::vector<NodeID>(forcedNodes.begin(), forcedNodes.end());
+    changedLabels.clear();
+    std::sort(forced.begin(), forced.end());
+    forced.erase(std::unique(forced.begin(), forced.end()), forced.end());
+    return forced;
 }
 
 std::vector<NodeID> InformativeGraph::getPicked() const
@@ -198,10 +453,12 @@ std::ostream& operator<<(std::ostream &os, const InformativeGraph &g)
 {
     os << "neighbors:" << std::endl;
     for ( NodeID node = 0; node < g.nodeCount(); node++ )
-        os << node << ": " << g.neighbors[node] << std::endl;
-    os << "edgeLabels:" << std::endl;
-    for ( std::pair<std::pair<NodeID,NodeID>, AgreeSetID> keyValue : g.edgeLabels )
-        os << keyValue.first << " -> " << keyValue.second << std::endl;
+    {
+        os << node << ":";
+        for ( NodeID neighbor : g.neighbors(node) )
+            os << ' ' << neighbor << "->" << g.getEdgeLabel(node, neighbor);
+        os << std::endl;
+    }
     os << "picked:";
     for ( NodeID node : g.getPicked() )
         os << ' ' << node;
@@ -4,6 +4,7 @@
 #include <string>
 #include <iostream>
 #include <limits.h>
+#include <span>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/functional/hash.hpp>
 #include <unordered_map>
@@ -21,28 +22,101 @@ class InformativeGraph
 {
 private:
     typedef std::pair<NodeID,NodeID> Edge;
-    // nodes store list of neighbors
-    std::vector<std::vector<NodeID>> neighbors;
-    // edge labels are stored separately
-    std::unordered_map<Edge,AgreeSetID,boost::hash<Edge>> edgeLabels;
+    // neighbor, with label of the connecting edge
+    struct Adjacent
+    {
+        NodeID node;
+        AgreeSetID label;
+    };
+    /**
+     * compressed sparse rows, (re-)built from edges added when first needed:
+     * neighbors of node are adjacent[offsets[node] .. offsets[node+1]), sorted by node ID,
+     * and removed edges stay in place with their alive bits cleared;
+     * twins holds the position of the reverse slot within the neighbor's range
+     */
+    mutable std::vector<size_t> offsets;
+    mutable std::vector<Adjacent> adjacent;
+    mutable std::vector<uint32_t> twins;
+    mutable boost::dynamic_bitset<> alive;
+    mutable std::vector<uint32_t> degrees;
+    /**
+     * alive neighbors of node are packed[offsets[node] .. offsets[node]+degrees[node]), in no particular order,
+     * removed ones are swapped behind them; packedSlots and positions map between packed and sorted positions
+     */
+    mutable std::vector<NodeID> packed;
+    mutable std::vector<uint32_t> packedSlots, positions;
+    /**
+     * edges with label ag are labelEdges[labelOffsets[ag] .. labelOffsets[ag+1]), as (v,w) with v < w,
+     * and labelSlots holds the slot of w among the neighbors of v
+     */
+    mutable std::vector<size_t> labelOffsets;
+    mutable std::vector<Edge> labelEdges;
+    mutable std::vector<size_t> labelSlots;
+    /**
+     * distinct labels adjacent to node are nodeLabels[nodeLabelOffsets[node] .. nodeLabelOffsets[node+1]), sorted,
+     * with number of alive edges (possible) and alive edges to picked nodes (certain) carrying them;
+     * slotLabels holds the position of each adjacency slot's label within the labels of its node
+     */
+    struct LabelCount
+    {
+        uint32_t possible, certain;
+    };
+    mutable std::vector<size_t> nodeLabelOffsets;
+    mutable std::vector<AgreeSetID> nodeLabels;
+    mutable std::vector<LabelCount> labelCounts;
+    mutable std::vector<uint32_t> slotLabels;
+    // number of labels with non-zero possible/certain count, per node
+    mutable std::vector<uint32_t> possibleSizes, certainSizes;
+    // labels whose edges have all been removed
+    mutable boost::dynamic_bitset<> removedLabels;
+    /**
+     * number of alive edges per label, and position of first alive edge among labelEdges;
+     * a node is forced by a label iff all its alive edges are adjacent to the node
+     */
+    mutable std::vector<uint32_t> liveCounts;
+    mutable std::vector<size_t> firstLive;
+    // labels with edges removed since last call to getNewlyForced, which may have become forcing
+    mutable std::vector<AgreeSetID> changedLabels;
+    mutable boost::dynamic_bitset<> labelChanged;
+    // edges added since last build
+    mutable std::vector<std::pair<Edge,AgreeSetID>> pending;
+    size_t nodes;
     // track which nodes have been already been picked
     boost::dynamic_bitset<> pickedNodes;
 
+    // merges edges added into compressed sparse rows
+    void build() const;
+    // (re-)computes label counts from alive edges
+    void countLabels() const;
+    // adjusts possible or certain count of label on adjacency slot of node by delta
+    void updateCount(NodeID node, size_t slot, bool certain, int delta) const;
+    // appends nodes forced by label ag
+    void addForced(AgreeSetID ag, std::vector<NodeID> &forced) const;
+    // position of w among neighbors of v (removed or not), or SIZE_MAX if v and w were never adjacent
+    size_t findAdjacent(NodeID v, NodeID w) const;
     // validate that graph is consistent, returning error message in msg
     bool validate(std::string &msg) const;
     bool hasEdge(NodeID v, NodeID w) const;
 
     void removeEdge(NodeID v, NodeID w);
+    // removes edge on given alive slot of v, in constant time
+    void removeSlot(NodeID v, size_t slot);
+    // moves slot of node behind its alive neighbors
+    void unpack(NodeID node, size_t slot);
     void removeAgreeSet(AgreeSetID ag, std::unordered_set<NodeID> *updated);
 
 public:
     InformativeGraph(size_t nodeCount = 0);
+    virtual ~InformativeGraph() = default;
 
     size_t nodeCount() const;
     size_t degree(NodeID node) const;
     AgreeSetID getEdgeLabel(NodeID v, NodeID w) const;
     bool picked(NodeID node) const;
 
+    // allocates space for nodes and edges upfront, for bulk building with known sizes
+    void reserve(size_t nodeCount, size_t edgeCount);
+    // edges are cheapest to add all at once before any other calls, as each batch of additions triggers a rebuild
     void addEdge(NodeID v, NodeID w, AgreeSetID ag);
     /**
      * marks node a picked; for each edge to other picked node removes all edges with same label
@@ -52,12 +126,22 @@ public:
     virtual void removeNode(NodeID node);
 
     std::vector<NodeID> getNeighbors(NodeID node) const;
+    // like getNeighbors, but without copying; only valid until the graph is modified
+    std::span<const NodeID> neighbors(NodeID node) const;
     // get AgreeSetIDs on adjacent edges, in order
     std::vector<AgreeSetID> getPossibleAgreeSets(NodeID node) const;
     // get AgreeSetIDs on adjacent edges to picked nodes, in order
     std::vector<AgreeSetID> getCertainAgreeSets(NodeID node) const;
+    // sizes of possible/certain agree sets, without listing them
+    size_t getPossibleAgreeSetCount(NodeID node) const;
+    size_t getCertainAgreeSetCount(NodeID node) const;
     // returns nodes that appear in all edges labeled with some particular agree-set
     std::vector<NodeID> getForced() const;
+    /**
+     * returns nodes forced by labels that had edges removed since the last call (all labels on first call),
+     * so that repeated calls only cost work proportional to the changes in between
+     */
+    std::vector<NodeID> getNewlyForced();
     // returns all nodes picked
     std::vector<NodeID> getPicked() const;
 
@@ -0,0 +1,98 @@
+#include <memory>
+#include <queue>
+#include <boost/log/trivial.hpp>
+
+#include "InformativeGreedy.h"
+#include "DominanceGraph.h"
+
+struct GreedyNode
+{
+    uint16_t certainSize, degree;
+    NodeID node;
+
+    GreedyNode(uint16_t certainSize, uint16_t degree, NodeID node) : certainSize(certainSize), degree(degree), node(node) {}
+    GreedyNode(const InformativeGraph &g, NodeID node) : node(node)
+    {
+        degree = g.degree(node);
+        certainSize = g.getCertainAgreeSetCount(node);
+    }
+
+    bool operator<(const GreedyNode &other) const
+    {
+#define compare(X,Y) if (X < Y) return true; if (X > Y) return false
+        compare(certainSize, other.certainSize);
+        compare(degree, other.degree);
+#undef compare
+        return node < other.node;
+    }
+    bool operator==(const GreedyNode &other) const
+    {
+        return certainSize == other.certainSize
+            && degree == other.degree
+            && node == other.node;
+    }
+};
+
+std::vector<NodeID> pickGreedy(const InformativeGraph &graph, bool pruning)
+{
+    std::priority_queue<GreedyNode> queue;
+    const size_t nodeCount = graph.nodeCount();
+    // only use DominanceGraph if we need to prune dominated nodes
+    std::unique_ptr<InformativeGraph> g(pruning ? new DominanceGraph(graph) : new InformativeGraph(graph));
+    DominanceGraph *gDom = dynamic_cast<DominanceGraph*>(g.get()); // to avoid repeated casting later
+    // prune once to ensure we only pick greedily on pruned graph
+    if ( pruning )
+    {
+        gDom->prune();
+    }
+    else
+    {
+        for ( NodeID node : g->getForced() )
+        {
+            BOOST_LOG_TRIVIAL(info) << "picking forced node " << node;
+            g->pickNode(node);
+        }
+    }
+    // prepare queue
+    for ( NodeID node = 0; node < nodeCount; node++ )
+    {
+        if ( g->degree(node) > 0 )
+            queue.push(GreedyNode(*g, node));
+    }
+    // repeated pick top element
+    while ( !queue.empty() )
+    {
+        GreedyNode next = queue.top();
+        queue.pop();
+        // check that node data is still accurate
+        GreedyNode currentValue(*g, next.node);
+        if ( next == currentValue )
+        {
+            if ( !g->picked(next.node) )
+            {
+                BOOST_LOG_TRIVIAL(info) << "picking node " << next.node;
+                // we don't care about updates from edge removal as this will only lower greedy weight
+                g->pickNode(next.node);
+                // certainSize of neighbors may have increased
+                for ( NodeID neighbor : g->neighbors(next.node) )
+                    // any current neighbor will have degree > 0
+                    queue.push(GreedyNode(*g, neighbor));
+                if ( pruning )
+                {
+                    // graph has changed, so we prune again - again ignoring edge removals
+                    std::vector<NodeID> pickedWhilePruning = gDom->prune();
+                    // neighbors of picked nodes need to be re-enqueued
+                    for ( NodeID pickedNode : pickedWhilePruning )
+                        for ( NodeID neighbor : g->neighbors(pickedNode) )
+                            queue.push(GreedyNode(*g, neighbor));
+                }
+            }
+        }
+        else if ( currentValue < next && currentValue.degree > 0 )
+        {
+            // re-enqueue for later processing
+            queue.push(currentValue);
+        }
+    }
+    return g->getPicked();
+}
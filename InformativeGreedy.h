@@ -0,0 +1,13 @@
+#ifndef INFORMATIVE_GREEDY_H
+#define INFORMATIVE_GREEDY_H
+
+#include "InformativeGraph.h"
+
+/**
+ * repeatedly pick node with largest (certain agree-set, degree) pair
+ * optionally prunes dominated nodes between greedy steps
+ * forced nodes are always picked first
+ */
+std::vector<NodeID> pickGreedy(const InformativeGraph &graph, bool pruning);
+
+#endif
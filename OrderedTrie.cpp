@@ -1,151 +1,291 @@
+#include <algorithm>
 #include <boost/log/trivial.hpp>
 #include "VectorUtil.h"
 
-//----------------- OrderedTrie::Node -----------
+//----------------- OrderedTrie (nodes) ---------
 
 template <typename T, typename Alphabet>
-bool OrderedTrie<T,Alphabet>::Node::empty() const
+template <typename V>
+void OrderedTrie<T,Alphabet>::grow(std::vector<V> &pool, Range &range)
 {
-    return ids.empty() && children.empty();
+    if ( range.size < range.capacity )
+        return;
+    const uint32_t capacity = std::max<uint32_t>(1, 2 * range.capacity);
+    if ( range.offset + range.capacity == pool.size() )
+    {
+        // last in pool, can grow in place
+        pool.resize(range.offset + capacity);
+    }
+    else
+    {
+        const uint32_t offset = pool.size();
+        pool.resize(offset + capacity);
+        std::copy(pool.begin() + range.offset, pool.begin() + range.offset + range.size, pool.begin() + offset);
+        range.offset = offset;
+        scattered += range.capacity;
+    }
+    range.capacity = capacity;
+}
+
+template <typename T, typename Alphabet>
+bool OrderedTrie<T,Alphabet>::byLabel(const Child &child, Alphabet label)
+{
+    return child.first < label;
 }
 
 template <typename T, typename Alphabet>
-void OrderedTrie<T,Alphabet>::Node::insert(T id, const Set &value, size_t index)
+typename OrderedTrie<T,Alphabet>::NodeIndex OrderedTrie<T,Alphabet>::child(NodeIndex node, Alphabet label) const
 {
-    if ( index >= value.size() )
-        ids.push_back(id);
+    const Range &children = nodes[node].children;
+    auto begin = childPool.begin() + children.offset, end = begin + children.size;
+    auto pos = std::lower_bound(begin, end, label, byLabel);
+    if ( pos == end || pos->first != label )
+        return NoNode;
+    return pos->second;
+}
+
+template <typename T, typename Alphabet>
+typename OrderedTrie<T,Alphabet>::NodeIndex OrderedTrie<T,Alphabet>::addChild(NodeIndex node, Alphabet label)
+{
+    const NodeIndex existing = child(node, label);
+    if ( existing != NoNode )
+        return existing;
+    NodeIndex index;
+    scattered++;
+    if ( freeNodes.empty() )
+    {
+        index = nodes.size();
+        nodes.emplace_back();
+    }
     else
     {
-        const Alphabet nextElem = value[index];
-        // find position to insert
-        auto child = children.begin();
-        while ( child < children.end() && child->first < nextElem )
-            child++;
-        // ensure existance of suitable child
-        if ( child == children.end() || child->first > nextElem )
-            child = children.insert(child, std::pair<Alphabet,Node>(nextElem, Node()));
-        // insert
-        child->second.insert(id, value, index + 1);
+        index = freeNodes.back();
+        freeNodes.pop_back();
     }
+    nodes[index] = Node{ label, node, Range{ 0, 0, 0 }, Range{ 0, 0, 0 } };
+    // children are usually added in order, e.g. when bulk loading, so this rarely shifts anything
+    Range &children = nodes[node].children;
+    grow(childPool, children);
+    auto begin = childPool.begin() + children.offset, end = begin + children.size;
+    auto pos = std::lower_bound(begin, end, label, byLabel);
+    std::copy_backward(pos, end, end + 1);
+    *pos = Child(label, index);
+    children.size++;
+    return index;
+}
+
+template <typename T, typename Alphabet>
+void OrderedTrie<T,Alphabet>::insertAt(NodeIndex node, T id)
+{
+    Range &ids = nodes[node].ids;
+    grow(idPool, ids);
+    locations[id] = Location{ node, ids.size };
+    idPool[ids.offset + ids.size++] = id;
+}
+
+template <typename T, typename Alphabet>
+bool OrderedTrie<T,Alphabet>::isPath(NodeIndex node, const Set &value) const
+{
+    // walk up from node, matching value from its end
+    for ( size_t index = value.size(); index-- > 0; node = nodes[node].parent )
+        if ( node == 0 || nodes[node].label != value[index] )
+            return false;
+    return node == 0;
 }
 
 template <typename T, typename Alphabet>
-void OrderedTrie<T,Alphabet>::Node::erase(T id, const Set &value, size_t index)
+void OrderedTrie<T,Alphabet>::layout()
 {
-    if ( index >= value.size() )
+    std::vector<Node> ordered;
+    std::vector<T> orderedIds;
+    std::vector<Child> orderedChildren;
+    ordered.reserve(nodes.size() - freeNodes.size());
+    orderedIds.reserve(locations.size());
+    orderedChildren.reserve(nodes.size() - freeNodes.size());
+    // old index of node, with new index of its parent and its position among the parent's children
+    struct Pending
+    {
+        NodeIndex node, parent;
+        uint32_t position;
+    };
+    std::vector<Pending> stack = { Pending{ 0, NoNode, 0 } };
+    while ( !stack.empty() )
     {
-        // remove id from ids
-        size_t pos = 0;
-        while ( ids[pos] != id )
-            pos++;
-        ids[pos] = ids.back();
-        ids.pop_back();
+        const Pending next = stack.back();
+        stack.pop_back();
+        const NodeIndex index = ordered.size();
+        const Node &old = nodes[next.node];
+        if ( next.parent != NoNode )
+            orderedChildren[ordered[next.parent].children.offset + next.position].second = index;
+        // node indices change, so ids must be relocated as well
+        Range ids{ uint32_t(orderedIds.size()), old.ids.size, old.ids.size };
+        for ( uint32_t i = 0; i < old.ids.size; i++ )
+        {
+            const T id = idPool[old.ids.offset + i];
+            orderedIds.push_back(id);
+            locations[id].node = index;
+        }
+        Range children{ uint32_t(orderedChildren.size()), old.children.size, old.children.size };
+        orderedChildren.insert(orderedChildren.end(), childPool.begin() + old.children.offset,
+                               childPool.begin() + old.children.offset + old.children.size);
+        ordered.push_back(Node{ old.label, next.parent, ids, children });
+        // push in reverse, so that children are visited in order
+        for ( uint32_t position = children.size; position-- > 0; )
+            stack.push_back(Pending{ orderedChildren[children.offset + position].second, index, position });
     }
-    else
+    nodes = std::move(ordered);
+    idPool = std::move(orderedIds);
+    childPool = std::move(orderedChildren);
+    freeNodes.clear();
+    scattered = 0;
+}
+
+template <typename T, typename Alphabet>
+void OrderedTrie<T,Alphabet>::eraseStored(T id)
+{
+    auto location = locations.find(id);
+    NodeIndex node = location->second.node;
+    Range &ids = nodes[node].ids;
+    // swap with last id
+    const uint32_t pos = location->second.position;
+    idPool[ids.offset + pos] = idPool[ids.offset + --ids.size];
+    locations[idPool[ids.offset + pos]].position = pos;
+    locations.erase(location);
+    // remove nodes left empty, other than root
+    while ( node != 0 && nodes[node].ids.size == 0 && nodes[node].children.size == 0 )
     {
-        // find containing child
-        auto child = children.begin();
-        while ( child->first != value[index] )
-            ++child;
-        // erase from child
-        child->second.erase(id, value, index + 1);
-        // erase child if now empty
-        if ( child->second.empty() )
-            children.erase(child);
+        const NodeIndex parent = nodes[node].parent;
+        Range &children = nodes[parent].children;
+        auto begin = childPool.begin() + children.offset, end = begin + children.size;
+        auto label = std::lower_bound(begin, end, nodes[node].label, byLabel);
+        std::copy(label + 1, end, label);
+        children.size--;
+        freeNodes.push_back(node);
+        node = parent;
     }
 }
 
 template <typename T, typename Alphabet>
-void OrderedTrie<T,Alphabet>::Node::findSubsets(const Set &s, size_t index, std::vector<T> &out) const
+template <typename Visitor>
+bool OrderedTrie<T,Alphabet>::visitSubsets(NodeIndex node, const Set &s, size_t index, Visitor &visit) const
 {
-    //BOOST_LOG_TRIVIAL(trace) << "Node::" << __FUNCTION__ << "(" << s << ',' << index << ',' << out << ")";
     // current prefix has been subset of s[0..index]
-    for ( T id : ids )
-        out.push_back(id);
+    const Node &n = nodes[node];
+    for ( uint32_t i = 0; i < n.ids.size; i++ )
+        if ( !visit(idPool[n.ids.offset + i]) )
+            return false;
     // check children
-    auto child = children.begin();
-    while ( index < s.size() && child < children.end() )
+    auto child = childPool.begin() + n.children.offset, end = child + n.children.size;
+    while ( index < s.size() && child < end )
     {
         if ( s[index] < child->first )
             index++;
         else if ( s[index] > child->first )
             child++;
-        else
-        {
-            //BOOST_LOG_TRIVIAL(trace) << "recursing @" << child->first;
-            (child++)->second.findSubsets(s, ++index, out);
-        }
+        else if ( !visitSubsets((child++)->second, s, ++index, visit) )
+            return false;
     }
+    return true;
 }
 
 template <typename T, typename Alphabet>
-void OrderedTrie<T,Alphabet>::Node::findSupersets(const Set &s, size_t index, std::vector<T> &out) const
+template <typename Visitor>
+bool OrderedTrie<T,Alphabet>::visitSupersets(NodeIndex node, const Set &s, size_t index, Visitor &visit) const
 {
-    //BOOST_LOG_TRIVIAL(trace) << "Node::" << __FUNCTION__ << "(" << s << ',' << index << ',' << out << ")";
     // current prefix has been superset of s[0..index]
+    const Node &n = nodes[node];
+    auto begin = childPool.begin() + n.children.offset, end = begin + n.children.size;
     if ( index >= s.size() )
     {
-        for ( T id : ids )
-            out.push_back(id);
+        for ( uint32_t i = 0; i < n.ids.size; i++ )
+            if ( !visit(idPool[n.ids.offset + i]) )
+                return false;
         // all children must be supersets as well
-        for ( const std::pair<Alphabet,Node> &child : children )
-        {
-            //BOOST_LOG_TRIVIAL(trace) << "recursing @" << child.first;
-            child.second.findSupersets(s, index, out);
-        }
-        return;
+        for ( auto child = begin; child < end; ++child )
+            if ( !visitSupersets(child->second, s, index, visit) )
+                return false;
+        return true;
     }
     // check children
-    for ( const std::pair<Alphabet,Node> &child : children )
+    for ( auto child = begin; child < end; ++child )
     {
-        if ( s[index] < child.first )
+        if ( s[index] < child->first )
             break; // as children are sorted, this condition won't change
-        else if ( s[index] > child.first )
-        {
-            //BOOST_LOG_TRIVIAL(trace) << "recursing @" << child.first;
-            child.second.findSupersets(s, index, out);
-        }
-        else
-        {
-            //BOOST_LOG_TRIVIAL(trace) << "recursing @" << child.first;
-            child.second.findSupersets(s, index + 1, out);
-        }
+        if ( !visitSupersets(child->second, s, s[index] == child->first ? index + 1 : index, visit) )
+            return false;
     }
+    return true;
 }
 
 //----------------- OrderedTrie ------------------
 
+template <typename T, typename Alphabet>
+OrderedTrie<T,Alphabet>::OrderedTrie() : nodes(1), scattered(0)
+{
+    nodes[0] = Node{ Alphabet(), NoNode, Range{ 0, 0, 0 }, Range{ 0, 0, 0 } };
+}
+
+template <typename T, typename Alphabet>
+OrderedTrie<T,Alphabet>::OrderedTrie(std::vector<std::pair<T,Set>> entries) : OrderedTrie()
+{
+    // in lexicographic order, each set only adds nodes after its common prefix with the previous set
+    // sorting stably keeps ids of equal sets in given order, as if inserted one at a time
+    std::stable_sort(entries.begin(), entries.end(),
+              [](const std::pair<T,Set> &a, const std::pair<T,Set> &b) { return a.second < b.second; });
+    // path[i] is node for first i elements of previous set
+    std::vector<NodeIndex> path = { 0 };
+    const Set *previous = nullptr;
+    for ( const std::pair<T,Set> &entry : entries )
+    {
+        const Set &value = entry.second;
+        size_t common = 0;
+        if ( previous != nullptr )
+            while ( common < value.size() && common < previous->size() && value[common] == (*previous)[common] )
+                common++;
+        path.resize(common + 1);
+        for ( size_t index = common; index < value.size(); index++ )
+            path.push_back(addChild(path.back(), value[index]));
+        insertAt(path.back(), entry.first);
+        previous = &value;
+    }
+    // nodes were created depth-first, but children of a node are spread out across the pool
+    layout();
+}
+
 template <typename T, typename Alphabet>
 bool OrderedTrie<T,Alphabet>::contains(T id) const
 {
-    return valueMap.count(id) > 0;
+    return locations.count(id) > 0;
 }
 
 template <typename T, typename Alphabet>
-const OrderedTrie<T,Alphabet>::Set& OrderedTrie<T,Alphabet>::at(T id) const
+typename OrderedTrie<T,Alphabet>::Set OrderedTrie<T,Alphabet>::at(T id) const
 {
-    return valueMap.at(id);
+    Set value;
+    for ( NodeIndex node = locations.at(id).node; node != 0; node = nodes[node].parent )
+        value.push_back(nodes[node].label);
+    std::reverse(value.begin(), value.end());
+    return value;
 }
 
 template <typename T, typename Alphabet>
 bool OrderedTrie<T,Alphabet>::insert(T id, const Set &value)
 {
-    if ( !contains(id) )
+    auto location = locations.find(id);
+    if ( location != locations.end() )
     {
-        valueMap[id] = value;
-        root.insert(id, value, 0);
-        return true;
+        if ( isPath(location->second.node, value) )
+            return false;
+        eraseStored(id);
     }
-    // update
-    Set &storedValue = valueMap[id];
-    if ( storedValue != value )
-    {
-        root.erase(id, storedValue, 0);
-        root.insert(id, value, 0);
-        storedValue = value;
-        return true;
-    }
-    return false;
+    NodeIndex node = 0;
+    for ( Alphabet elem : value )
+        node = addChild(node, elem);
+    insertAt(node, id);
+    // re-order once enough nodes were added out of order, so the cost is amortized over their insertions
+    if ( scattered > nodes.size() / 4 )
+        layout();
+    return true;
 }
 
 template <typename T, typename Alphabet>
@@ -153,8 +293,7 @@ bool OrderedTrie<T,Alphabet>::erase(T id)
 {
     if ( contains(id) )
     {
-        root.erase(id, valueMap.at(id), 0);
-        valueMap.erase(id);
+        eraseStored(id);
         return true;
     }
     return false;
@@ -164,7 +303,7 @@ template <typename T, typename Alphabet>
 std::vector<T> OrderedTrie<T,Alphabet>::findSubsets(const Set &s) const
 {
     std::vector<T> out;
-    root.findSubsets(s, 0, out);
+    visitSubsets(s, [&out](T id) { out.push_back(id); return true; });
     BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << "(" << s << ")=" << out;
     return out;
 }
@@ -173,7 +312,33 @@ template <typename T, typename Alphabet>
 std::vector<T> OrderedTrie<T,Alphabet>::findSupersets(const Set &s) const
 {
     std::vector<T> out;
-    root.findSupersets(s, 0, out);
+    visitSupersets(s, [&out](T id) { out.push_back(id); return true; });
     BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << "(" << s << ")=" << out;
     return out;
 }
+
+template <typename T, typename Alphabet>
+template <typename Visitor>
+bool OrderedTrie<T,Alphabet>::visitSubsets(const Set &s, Visitor visit) const
+{
+    return visitSubsets(0, s, 0, visit);
+}
+
+template <typename T, typename Alphabet>
+template <typename Visitor>
+bool OrderedTrie<T,Alphabet>::visitSupersets(const Set &s, Visitor visit) const
+{
+    return visitSupersets(0, s, 0, visit);
+}
+
+template <typename T, typename Alphabet>
+bool OrderedTrie<T,Alphabet>::hasSubset(const Set &s, T except) const
+{
+    return !visitSubsets(s, [except](T id) { return id == except; });
+}
+
+template <typename T, typename Alphabet>
+bool OrderedTrie<T,Alphabet>::hasSuperset(const Set &s, T except) const
+{
+    return !visitSupersets(s, [except](T id) { return id == except; });
+}
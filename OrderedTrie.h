@@ -1,6 +1,7 @@
 #ifndef ORDERED_TRIE_H
 #define ORDERED_TRIE_H
 
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <iostream>
@@ -14,34 +15,83 @@ public:
     // sets are represented as ordered vectors
     typedef std::vector<Alphabet> Set;
 private:
-    class Node
+    typedef uint32_t NodeIndex;
+    static const NodeIndex NoNode = UINT32_MAX;
+    typedef std::pair<Alphabet,NodeIndex> Child;
+    // part of a pool reserved for one node, relocated to end of pool when full
+    struct Range
     {
-        std::vector<T> ids;
-        std::vector<std::pair<Alphabet,Node>> children;
-    public:
-        bool empty() const;
-        void insert(T id, const Set &value, size_t index);
-        void erase(T id, const Set &value, size_t index);
-        void findSubsets(const Set &s, size_t index, std::vector<T> &out) const;
-        void findSupersets(const Set &s, size_t index, std::vector<T> &out) const;
-        // auto-generate non-templated friend function
-        friend std::ostream& operator<<(std::ostream &os, const Node &node)
-        {
-            return os << "<ids=" << node.ids << ", children=" << node.children << ">";
-        }
+        uint32_t offset, size, capacity;
     };
+    struct Node
+    {
+        Alphabet label;
+        NodeIndex parent;
+        // ids stored at node, and children sorted by label for binary search
+        Range ids, children;
+    };
+
+    // all nodes, linked by index, with root at index 0; erased nodes are kept for reuse
+    std::vector<Node> nodes;
+    std::vector<NodeIndex> freeNodes;
+    std::vector<T> idPool;
+    std::vector<Child> childPool;
+    // node storing id, and position of id within its ids; sets are only stored as paths
+    struct Location
+    {
+        NodeIndex node;
+        uint32_t position;
+    };
+    std::unordered_map<T,Location> locations;
+    // nodes created and pool entries abandoned since last layout, which degrade locality
+    size_t scattered;
 
-    Node root;
-    std::unordered_map<T,Set> valueMap;
+    // makes room for one more element in range, relocating it if needed
+    template <typename V>
+    void grow(std::vector<V> &pool, Range &range);
+    // compares children to labels, for binary search
+    static bool byLabel(const Child &child, Alphabet label);
+    // returns child of node with given label, or NoNode
+    NodeIndex child(NodeIndex node, Alphabet label) const;
+    // returns child of node with given label, creating it if needed
+    NodeIndex addChild(NodeIndex node, Alphabet label);
+    void insertAt(NodeIndex node, T id);
+    // checks whether path from root to node spells value, without rebuilding it
+    bool isPath(NodeIndex node, const Set &value) const;
+    // re-orders nodes depth-first and compacts pools, so that subtrees are contiguous
+    void layout();
+    // removes id, and nodes left empty
+    void eraseStored(T id);
+    // pass ids found to visit until it returns false; returns false if stopped early
+    template <typename Visitor>
+    bool visitSubsets(NodeIndex node, const Set &s, size_t index, Visitor &visit) const;
+    template <typename Visitor>
+    bool visitSupersets(NodeIndex node, const Set &s, size_t index, Visitor &visit) const;
 public:
+    OrderedTrie();
+    // bulk-loads sets with distinct ids, building nodes in order instead of inserting one set at a time
+    OrderedTrie(std::vector<std::pair<T,Set>> entries);
+
     bool contains(T id) const;
-    const Set& at(T id) const;
+    // rebuilds set from path of its node
+    Set at(T id) const;
     // insert or update; returns if changes were made
     bool insert(T id, const Set &value);
     // erase if present; returns if changes were made
     bool erase(T id);
     std::vector<T> findSubsets(const Set &s) const;
     std::vector<T> findSupersets(const Set &s) const;
+    /**
+     * calls visit(id) for ids of all stored subsets/supersets of s, without collecting them
+     * stops as soon as visit returns false, and returns false in that case
+     */
+    template <typename Visitor>
+    bool visitSubsets(const Set &s, Visitor visit) const;
+    template <typename Visitor>
+    bool visitSupersets(const Set &s, Visitor visit) const;
+    // check whether some subset/superset of s is stored under an id other than except, stopping at the first one
+    bool hasSubset(const Set &s, T except) const;
+    bool hasSuperset(const Set &s, T except) const;
 };
 
 // needed for proper linkage
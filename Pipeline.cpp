@@ -0,0 +1,213 @@
+#include <boost/log/trivial.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "CSVUtil.h"
+#include "AgreeSetMiner.h"
+#include "AgreeSetEdgeMiner.h"
+#include "InformativeGreedy.h"
+#include "VectorUtil.h"
+
+using namespace std;
+namespace po = boost::program_options;
+
+// settings shared by all data sets
+struct PipelineOptions
+{
+    MinerOptions miner;
+    EdgeLimits limits;
+    bool show = false;
+};
+
+// measures time since construction or last call
+class StageTimer
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+public:
+    double next()
+    {
+        const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        const double seconds = chrono::duration<double>(now - start).count();
+        start = now;
+        return seconds;
+    }
+};
+
+/**
+ * runs all stages on one CSV file, keeping the reduced table in memory throughout
+ * returns report, throws on failure
+ */
+static string runPipeline(const string &fileName, const PipelineOptions &options)
+{
+    ostringstream report, times;
+    report.precision(3);
+    times.precision(3);
+    times << fixed;
+    StageTimer timer;
+    Table table;
+    read_csv(table, fileName);
+    times << "read " << timer.next() << "s";
+    const size_t rows = table.size(), columns = table.empty() ? 0 : table[0].size();
+    const ReducedTable reduced(table);
+    table = Table();
+    times << ", reduce " << timer.next() << "s";
+    vector<AttributeSet> generators = getGenerators(reduced, options.miner);
+    sort(generators.begin(), generators.end());
+    times << ", mine " << timer.next() << "s";
+    // label edges by position of their agree set among sorted generators, like edgeMiner
+    const vector<vector<pair<size_t, size_t>>> edges = getAllAgreeSetEdges(reduced, generators, 1, options.limits);
+    InformativeGraph graph;
+    size_t edgeCount = 0;
+    for ( const vector<pair<size_t, size_t>> &genEdges : edges )
+        edgeCount += genEdges.size();
+    graph.reserve(rows, edgeCount);
+    for ( size_t genID = 0; genID < edges.size(); genID++ )
+        for ( const pair<size_t, size_t> &edge : edges[genID] )
+            graph.addEdge(edge.first, edge.second, genID);
+    times << ", edges " << timer.next() << "s";
+    const vector<NodeID> greedy = pickGreedy(graph, false);
+    times << ", greedy " << timer.next() << "s";
+    const vector<NodeID> pruned = pickGreedy(graph, true);
+    times << ", pruned " << timer.next() << "s";
+    report << fileName << ": " << rows << "x" << columns << ", " << generators.size() << " generators, "
+        << edgeCount << " edges, greedy " << greedy.size() << ", pruned " << pruned.size() << " nodes picked\n";
+    if ( options.show )
+        report << "  greedy: " << greedy << "\n  pruned: " << pruned << "\n";
+    report << "  " << times.str() << "\n";
+    return report.str();
+}
+
+// CSV files given directly, or contained in given directories
+static vector<string> collectInputs(const vector<string> &paths)
+{
+    vector<string> inputs;
+    for ( const string &path : paths )
+    {
+        if ( !filesystem::is_directory(path) )
+        {
+            inputs.push_back(path);
+            continue;
+        }
+        vector<string> found;
+        for ( const filesystem::directory_entry &entry : filesystem::directory_iterator(path) )
+            if ( entry.is_regular_file() && entry.path().extension() == ".csv" )
+                found.push_back(entry.path().string());
+        sort(found.begin(), found.end());
+        inputs.insert(inputs.end(), found.begin(), found.end());
+    }
+    return inputs;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<string> paths;
+    bool debug = false;
+    unsigned jobs = 1;
+    PipelineOptions options;
+    // extract command-line arguments
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "show options (this)")
+            ("debug,d", "print debug information")
+            ("input,i", po::value<vector<string>>(), "CSV files, or directories whose CSV files are processed")
+            ("jobs,j", po::value<unsigned>(), "number of data sets processed in parallel (default: 1)")
+            ("engine,e", po::value<string>(), "mining engine: auto (default), closure or pairs")
+            ("transversals,t", po::value<string>(), "transversal enumeration for closure engine: berge (default) or mmcs")
+            ("shared", "share generators found between searches for different rhs (closure engine)")
+            ("max-edges,m", po::value<size_t>(), "keep at most arg edges per generator")
+            ("representatives", "use only one of several rows that differ on constant/unique columns only")
+            ("show,s", "show nodes picked")
+        ;
+        po::positional_options_description pos;
+        pos.add("input", -1);
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+        po::notify(vm);
+
+        if ( vm.count("help") || !vm.count("input") )
+        {
+            cout << "usage: pipeline [options] file.csv|directory ...\n" << desc << endl;
+            return vm.count("help") ? 0 : 1;
+        }
+        paths = vm["input"].as<vector<string>>();
+        if ( vm.count("debug") )
+            debug = true;
+        if ( vm.count("jobs") )
+            jobs = max(1u, vm["jobs"].as<unsigned>());
+        if ( vm.count("engine") )
+        {
+            const string engine = vm["engine"].as<string>();
+            if ( engine == "closure" )
+                options.miner.engine = MinerOptions::Engine::Closure;
+            else if ( engine == "pairs" )
+                options.miner.engine = MinerOptions::Engine::Pairs;
+            else if ( engine != "auto" )
+                throw po::error("unknown engine " + engine);
+        }
+        if ( vm.count("transversals") )
+        {
+            const string transversals = vm["transversals"].as<string>();
+            if ( transversals == "mmcs" )
+                options.miner.transversals = MinerOptions::Transversals::MMCS;
+            else if ( transversals != "berge" )
+                throw po::error("unknown transversal algorithm " + transversals);
+        }
+        if ( vm.count("shared") )
+            options.miner.sharedTraversal = true;
+        if ( vm.count("max-edges") )
+            options.limits.maxEdges = vm["max-edges"].as<size_t>();
+        if ( vm.count("representatives") )
+            options.limits.representativesOnly = true;
+        if ( vm.count("show") )
+            options.show = true;
+    } catch(exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+
+    if ( debug )
+        boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::info );
+    else
+        boost::log::core::get()->set_filter( boost::log::trivial::severity >= boost::log::trivial::warning );
+    const vector<string> inputs = collectInputs(paths);
+    // reports are printed in input order, each as soon as it and all before it are done
+    vector<string> reports(inputs.size());
+    vector<bool> done(inputs.size(), false);
+    size_t printed = 0;
+    atomic<size_t> next(0);
+    atomic<bool> failed(false);
+    mutex m;
+    auto work = [&]() {
+        for ( size_t i = next++; i < inputs.size(); i = next++ )
+        {
+            string report;
+            try {
+                report = runPipeline(inputs[i], options);
+            } catch(exception& e) {
+                report = inputs[i] + ": " + e.what() + "\n";
+                failed = true;
+            }
+            lock_guard<mutex> lock(m);
+            reports[i] = move(report);
+            done[i] = true;
+            while ( printed < inputs.size() && done[printed] )
+                cout << reports[printed++] << flush;
+        }
+    };
+    vector<thread> workers;
+    for ( unsigned job = 1; job < jobs; job++ )
+        workers.emplace_back(work);
+    work();
+    for ( thread &worker : workers )
+        worker.join();
+    return failed ? 1 : 0;
+}
@@ -84,9 +84,11 @@ int main(int argc, char* argv[])
     // create agree sets
     Table table = getRandomTable(columns, rows);
     ClosureCalculator closure(table);
-    vector<AttributeSet> agreeSets = getGenerators(closure);
+    MinerOptions options;
+    options.sharedTraversal = true;
+    vector<AttributeSet> agreeSets = getGenerators(closure, options);
     BOOST_LOG_TRIVIAL(info) << "finding Armstrong table for " << agreeSets.size() << " agree-sets (mined from " << rows << " rows)";
     // find armstrong table
-    AgreeSetGraph g = findMinAgreeSetGraph(agreeSets, max_backtrack);
+    AgreeSetGraph g = findMinAgreeSetGraph(agreeSets, max_backtrack, true);
     return 0;
 }
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include "VectorUtil.h"
+
+template <typename T, typename Alphabet>
+typename SignatureIndex<T,Alphabet>::Signature SignatureIndex<T,Alphabet>::signatureOf(const Set &s)
+{
+    Signature signature = {};
+    for ( Alphabet elem : s )
+    {
+        // multiplicative hashing spreads consecutive labels across words
+        const uint64_t bit = (uint64_t(elem) * 0x9E3779B97F4A7C15ull) >> (64 - 8);
+        signature[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    return signature;
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::covers(const Signature &super, const Signature &sub)
+{
+    uint64_t missing = 0;
+    for ( size_t word = 0; word < SignatureWords; word++ )
+        missing |= sub[word] & ~super[word];
+    return missing == 0;
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::isSubsetAt(size_t pos, const Set &s) const
+{
+    const Set &value = members[pos].group->first;
+    return std::includes(s.begin(), s.end(), value.begin(), value.end());
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::isSupersetAt(size_t pos, const Set &s) const
+{
+    const Set &value = members[pos].group->first;
+    return std::includes(value.begin(), value.end(), s.begin(), s.end());
+}
+
+template <typename T, typename Alphabet>
+void SignatureIndex<T,Alphabet>::joinGroup(size_t pos, const Set &value)
+{
+    const typename Groups::iterator group = groups.try_emplace(value).first;
+    members[pos] = Member{ group, uint32_t(group->second.size()) };
+    group->second.push_back(ids[pos]);
+}
+
+template <typename T, typename Alphabet>
+void SignatureIndex<T,Alphabet>::leaveGroup(size_t pos)
+{
+    const Member member = members[pos];
+    std::vector<T> &groupIds = member.group->second;
+    // swap with last id, as OrderedTrie does
+    groupIds[member.rank] = groupIds.back();
+    members[positions[groupIds.back()]].rank = member.rank;
+    groupIds.pop_back();
+    if ( groupIds.empty() )
+        groups.erase(member.group);
+}
+
+template <typename T, typename Alphabet>
+void SignatureIndex<T,Alphabet>::eraseAt(size_t pos)
+{
+    leaveGroup(pos);
+    positions.erase(ids[pos]);
+    if ( pos + 1 < ids.size() )
+    {
+        signatures[pos] = signatures.back();
+        ids[pos] = ids.back();
+        members[pos] = members.back();
+        positions[ids[pos]] = pos;
+    }
+    signatures.pop_back();
+    ids.pop_back();
+    members.pop_back();
+}
+
+template <typename T, typename Alphabet>
+template <typename Visitor>
+bool SignatureIndex<T,Alphabet>::visitInOrder(std::vector<size_t> &found, Visitor &visit) const
+{
+    std::sort(found.begin(), found.end(), [this](size_t a, size_t b) {
+        const Member &x = members[a], &y = members[b];
+        return x.group == y.group ? x.rank < y.rank : x.group->first < y.group->first;
+    });
+    for ( size_t pos : found )
+        if ( !visit(ids[pos]) )
+            return false;
+    return true;
+}
+
+template <typename T, typename Alphabet>
+SignatureIndex<T,Alphabet>::SignatureIndex(std::vector<std::pair<T,Set>> entries)
+{
+    signatures.reserve(entries.size());
+    ids.reserve(entries.size());
+    members.resize(entries.size());
+    for ( std::pair<T,Set> &entry : entries )
+    {
+        positions[entry.first] = ids.size();
+        signatures.push_back(signatureOf(entry.second));
+        ids.push_back(entry.first);
+        joinGroup(ids.size() - 1, entry.second);
+    }
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::contains(T id) const
+{
+    return positions.count(id) > 0;
+}
+
+template <typename T, typename Alphabet>
+const typename SignatureIndex<T,Alphabet>::Set& SignatureIndex<T,Alphabet>::at(T id) const
+{
+    return members[positions.at(id)].group->first;
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::insert(T id, const Set &value)
+{
+    auto pos = positions.find(id);
+    if ( pos != positions.end() )
+    {
+        if ( members[pos->second].group->first == value )
+            return false;
+        // update in place, but move to end of new group, as OrderedTrie does
+        signatures[pos->second] = signatureOf(value);
+        leaveGroup(pos->second);
+        joinGroup(pos->second, value);
+        return true;
+    }
+    positions[id] = ids.size();
+    signatures.push_back(signatureOf(value));
+    ids.push_back(id);
+    members.emplace_back();
+    joinGroup(ids.size() - 1, value);
+    return true;
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::erase(T id)
+{
+    auto pos = positions.find(id);
+    if ( pos == positions.end() )
+        return false;
+    eraseAt(pos->second);
+    return true;
+}
+
+template <typename T, typename Alphabet>
+template <typename Visitor>
+bool SignatureIndex<T,Alphabet>::visitSubsets(const Set &s, Visitor visit) const
+{
+    const Signature signature = signatureOf(s);
+    std::vector<size_t> found;
+    for ( size_t pos = 0; pos < ids.size(); pos++ )
+        if ( covers(signature, signatures[pos]) && isSubsetAt(pos, s) )
+            found.push_back(pos);
+    return visitInOrder(found, visit);
+}
+
+template <typename T, typename Alphabet>
+template <typename Visitor>
+bool SignatureIndex<T,Alphabet>::visitSupersets(const Set &s, Visitor visit) const
+{
+    const Signature signature = signatureOf(s);
+    std::vector<size_t> found;
+    for ( size_t pos = 0; pos < ids.size(); pos++ )
+        if ( covers(signatures[pos], signature) && isSupersetAt(pos, s) )
+            found.push_back(pos);
+    return visitInOrder(found, visit);
+}
+
+template <typename T, typename Alphabet>
+std::vector<T> SignatureIndex<T,Alphabet>::findSubsets(const Set &s) const
+{
+    std::vector<T> out;
+    visitSubsets(s, [&out](T id) { out.push_back(id); return true; });
+    BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << "(" << s << ")=" << out;
+    return out;
+}
+
+template <typename T, typename Alphabet>
+std::vector<T> SignatureIndex<T,Alphabet>::findSupersets(const Set &s) const
+{
+    std::vector<T> out;
+    visitSupersets(s, [&out](T id) { out.push_back(id); return true; });
+    BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << "(" << s << ")=" << out;
+    return out;
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::hasSubset(const Set &s, T except) const
+{
+    // order does not matter here, so stop at the first match
+    const Signature signature = signatureOf(s);
+    for ( size_t pos = 0; pos < ids.size(); pos++ )
+        if ( covers(signature, signatures[pos]) && ids[pos] != except && isSubsetAt(pos, s) )
+            return true;
+    return false;
+}
+
+template <typename T, typename Alphabet>
+bool SignatureIndex<T,Alphabet>::hasSuperset(const Set &s, T except) const
+{
+    const Signature signature = signatureOf(s);
+    for ( size_t pos = 0; pos < ids.size(); pos++ )
+        if ( covers(signatures[pos], signature) && ids[pos] != except && isSupersetAt(pos, s) )
+            return true;
+    return false;
+}
@@ -0,0 +1,89 @@
+#ifndef SIGNATURE_INDEX_H
+#define SIGNATURE_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * alternative to OrderedTrie with the same interface, for sets with many elements
+ * each set gets a fixed-width bit signature with one hashed bit per element; queries scan all signatures,
+ * so cost does not depend on how queries fan out across a trie, and verify candidates passing the filter exactly
+ * visitors see ids in the same order as with OrderedTrie, so that callers behave the same with either index
+ */
+template <typename T, typename Alphabet>
+class SignatureIndex
+{
+public:
+    // sets are represented as ordered vectors
+    typedef std::vector<Alphabet> Set;
+private:
+    static const size_t SignatureWords = 4;
+    typedef std::array<uint64_t, SignatureWords> Signature;
+
+    /**
+     * ids sharing the same set, in the order OrderedTrie keeps them at the set's node:
+     * appended on insert, and replaced by the last one on erase
+     */
+    typedef std::map<Set, std::vector<T>> Groups;
+    struct Member
+    {
+        typename Groups::iterator group;
+        uint32_t rank;
+    };
+
+    // entries stored densely, removed by swapping with the last entry
+    std::vector<Signature> signatures;
+    std::vector<T> ids;
+    std::vector<Member> members;
+    std::unordered_map<T,size_t> positions;
+    Groups groups;
+
+    static Signature signatureOf(const Set &s);
+    // true if all bits of sub are set in super, written branch-free so that it vectorizes
+    static bool covers(const Signature &super, const Signature &sub);
+    // exact checks for entries whose signatures pass the filter
+    bool isSubsetAt(size_t pos, const Set &s) const;
+    bool isSupersetAt(size_t pos, const Set &s) const;
+    void joinGroup(size_t pos, const Set &value);
+    void leaveGroup(size_t pos);
+    void eraseAt(size_t pos);
+    // visits ids at given positions as OrderedTrie would: depth-first, i.e. by set in lexicographic order, then by rank
+    template <typename Visitor>
+    bool visitInOrder(std::vector<size_t> &found, Visitor &visit) const;
+public:
+    SignatureIndex() = default;
+    // members refer to groups by iterator, which a copy would not update
+    SignatureIndex(const SignatureIndex&) = delete;
+    SignatureIndex& operator=(const SignatureIndex&) = delete;
+    SignatureIndex(SignatureIndex&&) = default;
+    SignatureIndex& operator=(SignatureIndex&&) = default;
+    // bulk-loads sets with distinct ids
+    SignatureIndex(std::vector<std::pair<T,Set>> entries);
+
+    bool contains(T id) const;
+    const Set& at(T id) const;
+    // insert or update; returns if changes were made
+    bool insert(T id, const Set &value);
+    // erase if present; returns if changes were made
+    bool erase(T id);
+    std::vector<T> findSubsets(const Set &s) const;
+    std::vector<T> findSupersets(const Set &s) const;
+    /**
+     * calls visit(id) for ids of all stored subsets/supersets of s, without collecting them
+     * stops as soon as visit returns false, and returns false in that case
+     */
+    template <typename Visitor>
+    bool visitSubsets(const Set &s, Visitor visit) const;
+    template <typename Visitor>
+    bool visitSupersets(const Set &s, Visitor visit) const;
+    // check whether some subset/superset of s is stored under an id other than except, stopping at the first one
+    bool hasSubset(const Set &s, T except) const;
+    bool hasSuperset(const Set &s, T except) const;
+};
+
+// needed for proper linkage
+#include "SignatureIndex.cpp"
+#endif
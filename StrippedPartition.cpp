@@ -0,0 +1,72 @@
+#include <algorithm>
+
+#include "StrippedPartition.h"
+
+using namespace std;
+
+StrippedPartition::StrippedPartition(size_t rowCount)
+{
+    if ( rowCount < 2 )
+        return;
+    rows.resize(rowCount);
+    for ( size_t row = 0; row < rowCount; row++ )
+        rows[row] = row;
+    classEnds.push_back(rowCount);
+}
+
+StrippedPartition StrippedPartition::ofColumn(const Table &table, size_t column)
+{
+    vector<pair<size_t, RowID>> byValue(table.size());
+    for ( size_t row = 0; row < table.size(); row++ )
+        byValue[row] = make_pair(table[row][column], row);
+    sort(byValue.begin(), byValue.end());
+    StrippedPartition p;
+    p.addClasses(byValue);
+    return p;
+}
+
+StrippedPartition StrippedPartition::refine(span<const size_t> values) const
+{
+    StrippedPartition p;
+    p.rows.reserve(rows.size());
+    vector<pair<size_t, RowID>> byValue;
+    for ( size_t c = 0; c < classCount(); c++ )
+    {
+        byValue.clear();
+        for ( RowID row : (*this)[c] )
+            byValue.push_back(make_pair(values[row], row));
+        sort(byValue.begin(), byValue.end());
+        p.addClasses(byValue);
+    }
+    return p;
+}
+
+void StrippedPartition::addClasses(const vector<pair<size_t, RowID>> &byValue)
+{
+    for ( size_t start = 0, end; start < byValue.size(); start = end )
+    {
+        for ( end = start + 1; end < byValue.size() && byValue[end].first == byValue[start].first; end++ )
+            ;
+        if ( end - start < 2 )
+            continue;
+        for ( size_t i = start; i < end; i++ )
+            rows.push_back(byValue[i].second);
+        classEnds.push_back(rows.size());
+    }
+}
+
+size_t StrippedPartition::classCount() const
+{
+    return classEnds.size();
+}
+
+size_t StrippedPartition::size() const
+{
+    return rows.size();
+}
+
+span<const RowID> StrippedPartition::operator[](size_t classID) const
+{
+    const size_t start = classID == 0 ? 0 : classEnds[classID - 1];
+    return span<const RowID>(rows.data() + start, classEnds[classID] - start);
+}
@@ -0,0 +1,34 @@
+#ifndef STRIPPED_PARTITION_H
+#define STRIPPED_PARTITION_H
+
+#include <span>
+#include "AgreeSetTypes.h"
+
+/**
+ * partition of rows into equivalence classes of rows with equal values (on some set of columns)
+ * classes containing only a single row are omitted
+ */
+class StrippedPartition
+{
+    // rows of all classes, each class stored consecutively
+    std::vector<RowID> rows;
+    // end of each class within rows
+    std::vector<size_t> classEnds;
+
+    // adds a class for each run of at least two rows with equal value in byValue, which must be sorted
+    void addClasses(const std::vector<std::pair<size_t, RowID>> &byValue);
+public:
+    // partition with all rows of the table in a single class
+    StrippedPartition(size_t rowCount = 0);
+    // partition by values of a single column
+    static StrippedPartition ofColumn(const Table &table, size_t column);
+    // splits each class by the given values (indexed by row), e.g. a column of a ColumnTable
+    StrippedPartition refine(std::span<const size_t> values) const;
+
+    size_t classCount() const;
+    // number of rows contained in classes
+    size_t size() const;
+    std::span<const RowID> operator[](size_t classID) const;
+};
+
+#endif
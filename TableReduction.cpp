@@ -0,0 +1,136 @@
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/log/trivial.hpp>
+#include <boost/functional/hash.hpp>
+
+#include "TableReduction.h"
+#include "BoostUtil.h"
+
+using namespace std;
+
+// assigns ids to rows such that equal rows get the same id; returns number of distinct rows
+static size_t groupEqualRows(const Table &table, vector<size_t> &ids)
+{
+    struct RowHash { size_t operator()(const Row *row) const { return boost::hash_range(row->begin(), row->end()); } };
+    struct RowEqual { bool operator()(const Row *a, const Row *b) const { return *a == *b; } };
+    unordered_map<const Row*, size_t, RowHash, RowEqual> idOf;
+    ids.resize(table.size());
+    for ( size_t i = 0; i < table.size(); i++ )
+        ids[i] = idOf.emplace(&table[i], idOf.size()).first->second;
+    return idOf.size();
+}
+
+ReducedTable::ReducedTable(const Table &original) : originalColumns(original.empty() ? 0 : original[0].size()),
+    constant(originalColumns), unique(originalColumns), hasKeyAgreeSet(false)
+{
+    // collapse duplicate rows
+    size_t distinctCount = groupEqualRows(original, distinctID);
+    vector<const Row*> distinctRows(distinctCount, nullptr);
+    for ( size_t i = 0; i < original.size(); i++ )
+        if ( distinctRows[distinctID[i]] == nullptr )
+            distinctRows[distinctID[i]] = &original[i];
+    // identify trivial columns
+    for ( size_t col = 0; col < originalColumns; col++ )
+    {
+        unordered_set<size_t> values;
+        for ( const Row *row : distinctRows )
+            values.insert((*row)[col]);
+        if ( values.size() == 1 )
+            constant.set(col);
+        else if ( values.size() == distinctCount )
+            unique.set(col);
+        else
+            kept.push_back(col);
+    }
+    // project onto remaining columns; rows differing on unique columns only may collapse
+    Table projected(distinctCount, Row(kept.size()));
+    for ( size_t id = 0; id < distinctCount; id++ )
+        for ( size_t col = 0; col < kept.size(); col++ )
+            projected[id][col] = (*distinctRows[id])[kept[col]];
+    vector<size_t> reducedID;
+    size_t reducedCount = groupEqualRows(projected, reducedID);
+    hasKeyAgreeSet = reducedCount < distinctCount;
+    table.resize(reducedCount);
+    originalRows.resize(reducedCount);
+    for ( size_t id = 0; id < distinctCount; id++ )
+        if ( table[reducedID[id]].empty() )
+            table[reducedID[id]] = move(projected[id]);
+    for ( size_t i = 0; i < original.size(); i++ )
+        originalRows[reducedID[distinctID[i]]].push_back(i);
+    columnTable = ColumnTable(table);
+    BOOST_LOG_TRIVIAL(info) << "reduced table from " << original.size() << "x" << originalColumns
+        << " to " << table.size() << "x" << kept.size() << " (" << constant.count() << " constant, "
+        << unique.count() << " unique columns)";
+}
+
+size_t ReducedTable::columns() const
+{
+    return originalColumns;
+}
+
+AttributeSet ReducedTable::expand(const AttributeSet &x) const
+{
+    AttributeSet result(constant);
+    for ( size_t col = 0; col < kept.size(); col++ )
+        if ( x[col] )
+            result.set(kept[col]);
+    return result;
+}
+
+AttributeSet ReducedTable::reduce(const AttributeSet &x) const
+{
+    AttributeSet result(kept.size());
+    for ( size_t col = 0; col < kept.size(); col++ )
+        result[col] = x[kept[col]];
+    return result;
+}
+
+vector<AttributeSet> ReducedTable::expandGenerators(const vector<AttributeSet> &generators) const
+{
+    vector<AttributeSet> result;
+    for ( const AttributeSet &gen : generators )
+        result.push_back(expand(gen));
+    // maximal for any unique column, and not visible in reduced table as it contains all reduced columns
+    if ( hasKeyAgreeSet )
+        result.push_back(expand(AttributeSet(kept.size()).flip()));
+    return result;
+}
+
+vector<pair<size_t, size_t>> ReducedTable::expandEdges(const vector<pair<size_t, size_t>> &edges) const
+{
+    vector<pair<size_t, size_t>> result;
+    for ( const pair<size_t, size_t> &edge : edges )
+        for ( size_t v : originalRows[edge.first] )
+            for ( size_t w : originalRows[edge.second] )
+                result.push_back(v < w ? make_pair(v, w) : make_pair(w, v));
+    return result;
+}
+
+bool ReducedTable::isKeyAgreeSet(const AttributeSet &x) const
+{
+    return hasKeyAgreeSet && x == expand(AttributeSet(kept.size()).flip());
+}
+
+vector<pair<size_t, size_t>> ReducedTable::getKeyAgreeSetEdges(bool representativesOnly) const
+{
+    vector<pair<size_t, size_t>> result;
+    for ( const vector<size_t> &rows : originalRows )
+    {
+        // the first row differs from some other row iff the group holds distinct rows
+        const size_t firstRows = representativesOnly ? min<size_t>(rows.size(), 1) : rows.size();
+        for ( size_t i = 0; i < firstRows; i++ )
+            for ( size_t j = i + 1; j < rows.size(); j++ )
+                if ( distinctID[rows[i]] != distinctID[rows[j]] )
+                {
+                    result.push_back(make_pair(rows[i], rows[j]));
+                    if ( representativesOnly )
+                        break;
+                }
+    }
+    return result;
+}
+
+const vector<size_t>& ReducedTable::getOriginalRows(size_t reducedRow) const
+{
+    return originalRows[reducedRow];
+}
@@ -0,0 +1,53 @@
+#ifndef TABLE_REDUCTION_H
+#define TABLE_REDUCTION_H
+
+#include "AgreeSetUtil.h"
+
+/**
+ * table with duplicate rows as well as constant and unique (key) columns removed
+ * none of these change the generators, so results on the reduced table can be mapped back
+ */
+class ReducedTable
+{
+    size_t originalColumns;
+    // original index of each column kept
+    IndexSet kept;
+    // columns with one value only - these are contained in every agree set
+    AttributeSet constant;
+    // columns with all-distinct values (after de-duplication) - these are contained in no agree set
+    AttributeSet unique;
+    // true if two distinct rows differ on unique columns only
+    bool hasKeyAgreeSet;
+    // original rows represented by each reduced row
+    std::vector<std::vector<size_t>> originalRows;
+    // rows in original table that are duplicates share the same distinct ID
+    std::vector<size_t> distinctID;
+public:
+    // reduced table, may have no columns left
+    Table table;
+    // same as table, in column-major order
+    ColumnTable columnTable;
+
+    ReducedTable(const Table &original);
+    // number of columns in original table
+    size_t columns() const;
+    // map attribute set over reduced columns to original columns (adding constant columns)
+    AttributeSet expand(const AttributeSet &x) const;
+    // map attribute set over original columns to reduced columns
+    AttributeSet reduce(const AttributeSet &x) const;
+    // map generators of reduced table to generators of original table
+    std::vector<AttributeSet> expandGenerators(const std::vector<AttributeSet> &generators) const;
+    // map vertex pairs of reduced table to all corresponding pairs of original rows
+    std::vector<std::pair<size_t, size_t>> expandEdges(const std::vector<std::pair<size_t, size_t>> &edges) const;
+    /**
+     * returns true if x is the agree set of original rows that collapsed into the same reduced row
+     * (i.e. all columns except the unique ones); edges then are given by getKeyAgreeSetEdges
+     */
+    bool isKeyAgreeSet(const AttributeSet &x) const;
+    // if representativesOnly is set, returns only one pair per reduced row
+    std::vector<std::pair<size_t, size_t>> getKeyAgreeSetEdges(bool representativesOnly = false) const;
+    // original rows represented by reduced row, in increasing order
+    const std::vector<size_t>& getOriginalRows(size_t reducedRow) const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "VectorUtil.h"
+#include "AgreeSetMiner.h"
 #include "AgreeSetEdgeMiner.h"
 
 using namespace std;
@@ -34,3 +35,109 @@ BOOST_AUTO_TEST_CASE( test_getAgreeSetEdges )
         BOOST_CHECK_EQUAL( edges, expected[test] );
     }
 }
+
+BOOST_AUTO_TEST_CASE( test_getAgreeSetEdges_reduced )
+{
+    Table t = {
+        { 0, 5, 0, 0 },
+        { 0, 5, 1, 1 },
+        { 0, 5, 1, 1 },
+        { 1, 5, 0, 2 },
+        { 0, 5, 1, 4 },
+        { 0, 5, 0, 3 }
+    };
+    ReducedTable reduced(t);
+    ClosureCalculator closure(t);
+    for ( const AttributeSet &gen : getGenerators(closure) )
+    {
+        BOOST_CHECK_EQUAL( sorted(getAgreeSetEdges(reduced, gen)), sorted(getAgreeSetEdges(t, gen)) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_getAllAgreeSetEdges )
+{
+    srand(3);
+    for ( int test = 0; test < 30; test++ )
+    {
+        Table t(5 + rand() % 30, Row(5));
+        for ( size_t row = 0; row < t.size(); row++ )
+            for ( size_t col = 0; col < 5; col++ )
+                t[row][col] = rand() % (col + 2);
+        // generators plus some agree sets that are not
+        vector<AttributeSet> agreeSets = getGenerators(t);
+        agreeSets.push_back(AttributeSet(5));
+        agreeSets.push_back(AttributeSet(5).set(1).set(3));
+        sort(agreeSets.begin(), agreeSets.end());
+        agreeSets.erase(unique(agreeSets.begin(), agreeSets.end()), agreeSets.end());
+        const ColumnTable columns(t);
+        const ReducedTable reduced(t);
+        for ( unsigned threads : { 1, 3 } )
+        {
+            vector<vector<pair<size_t,size_t>>> all = getAllAgreeSetEdges(columns, agreeSets, threads);
+            vector<vector<pair<size_t,size_t>>> allReduced = getAllAgreeSetEdges(reduced, agreeSets, threads);
+            BOOST_REQUIRE_EQUAL( all.size(), agreeSets.size() );
+            for ( size_t i = 0; i < agreeSets.size(); i++ )
+            {
+                BOOST_CHECK_EQUAL( all[i], sorted(getAgreeSetEdges(t, agreeSets[i])) );
+                BOOST_CHECK_EQUAL( allReduced[i], sorted(getAgreeSetEdges(reduced, agreeSets[i])) );
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_EdgeLimits )
+{
+    srand(5);
+    for ( int test = 0; test < 20; test++ )
+    {
+        // few values and repeated rows, so that some agree sets have many edges
+        Table t(10 + rand() % 40, Row(4));
+        for ( size_t row = 0; row < t.size(); row++ )
+            for ( size_t col = 0; col < 4; col++ )
+                t[row][col] = col == 3 ? row : rand() % (col + 2);
+        const ReducedTable reduced(t);
+        vector<AttributeSet> agreeSets = getGenerators(t);
+        sort(agreeSets.begin(), agreeSets.end());
+        const vector<vector<pair<size_t,size_t>>> all = getAllAgreeSetEdges(reduced, agreeSets);
+        EdgeLimits first, sampled, representatives;
+        first.maxEdges = sampled.maxEdges = 3;
+        sampled.sampleSeed = 17;
+        representatives.representativesOnly = true;
+        for ( const EdgeLimits &limits : { first, sampled, representatives } )
+        {
+            const vector<vector<pair<size_t,size_t>>> limited = getAllAgreeSetEdges(reduced, agreeSets, 2, limits);
+            BOOST_CHECK( limited == getAllAgreeSetEdges(reduced, agreeSets, 1, limits) );
+            for ( size_t i = 0; i < agreeSets.size(); i++ )
+            {
+                // limited edges are a subset, and every label keeps some edge
+                BOOST_CHECK_EQUAL( limited[i].empty(), all[i].empty() );
+                BOOST_CHECK_LE( limited[i].size(), limits.maxEdges );
+                BOOST_CHECK( includes(all[i].begin(), all[i].end(), limited[i].begin(), limited[i].end()) );
+                if ( !limits.representativesOnly )
+                    BOOST_CHECK_EQUAL( limited[i].size(), min(all[i].size(), limits.maxEdges) );
+                BOOST_CHECK_EQUAL( sorted(getAgreeSetEdges(reduced, agreeSets[i], limits)).size(), limited[i].size() );
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_EdgeLimits_weighted )
+{
+    // rows 0,1 and 2,3 agree on first column only
+    const ColumnTable columns(Table({ { 0, 0 }, { 0, 1 }, { 1, 2 }, { 1, 3 } }));
+    const vector<size_t> weights = { 10, 10, 1, 1 };
+    EdgeLimits limits;
+    limits.maxEdges = 1;
+    limits.rowWeights = &weights;
+    // edge (0,1) weighs 100 times as much as edge (2,3), so it should be kept almost always
+    size_t heavy = 0;
+    for ( uint64_t seed = 1; seed <= 200; seed++ )
+    {
+        limits.sampleSeed = seed;
+        const vector<pair<size_t,size_t>> edges = getAgreeSetEdges(columns, AttributeSet(2).set(0), limits);
+        BOOST_REQUIRE_EQUAL( edges.size(), 1 );
+        heavy += edges[0] == make_pair<size_t,size_t>(0, 1);
+    }
+    BOOST_CHECK_GT( heavy, 180 );
+    BOOST_CHECK_LT( heavy, 200 );
+}
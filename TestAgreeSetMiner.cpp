@@ -2,9 +2,13 @@
 #include <boost/dynamic_bitset.hpp>
 #include <boost/test/unit_test.hpp>
 #include <map>
+#include <set>
 
 #include "VectorUtil.h"
 #include "AgreeSetMiner.h"
+#include "AgreeSetPairMiner.h"
+#include "HittingSet.h"
+#include "AgreeSetIncrementalMiner.h"
 #include "BoostUtil.h"
 #include "BoostTestNoLog.h" // disable logging during test
 
@@ -35,6 +39,35 @@ BOOST_AUTO_TEST_CASE( test_ClosureCalculator )
         BOOST_CHECK_EQUAL( closure(mapping.first), mapping.second );
 }
 
+BOOST_AUTO_TEST_CASE( test_ClosureCalculator_refinement )
+{
+    srand(3);
+    for ( int test = 0; test < 20; test++ )
+    {
+        Table t(30, Row(8));
+        for ( Row &row : t )
+            for ( size_t col = 0; col < row.size(); col++ )
+                row[col] = rand() % (2 + col % 4);
+        ClosureCalculator cc(t);
+        // grow random sets one column at a time, so that groupings get refined
+        for ( int run = 0; run < 10; run++ )
+        {
+            AttributeSet x(8);
+            for ( size_t step = 0; step < 5; step++ )
+            {
+                x.set(rand() % 8);
+                AttributeSet expected(8);
+                expected.flip();
+                for ( size_t a = 0; a < t.size(); a++ )
+                    for ( size_t b = a + 1; b < t.size(); b++ )
+                        if ( x.is_subset_of(agreeSetOf(t[a], t[b])) )
+                            expected &= agreeSetOf(t[a], t[b]);
+                BOOST_CHECK_EQUAL( cc(x), expected );
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE( test_getGenerators )
 {
     vector<AttributeSet> gen = getGenerators(closure);
@@ -47,3 +80,270 @@ BOOST_AUTO_TEST_CASE( test_getGenerators )
     sort(expected.begin(), expected.end());
     BOOST_CHECK_EQUAL( gen, expected );
 }
+
+//----------------- ReducedTable ----------------
+
+static vector<AttributeSet> mineDirectly(const Table &t)
+{
+    ClosureCalculator c(t);
+    return sorted(getGenerators(c));
+}
+
+BOOST_AUTO_TEST_CASE( test_ReducedTable )
+{
+    // duplicate rows, constant column 1 and unique column 3
+    Table t = {
+        { 0, 5, 0, 0, 1 },
+        { 0, 5, 1, 1, 1 },
+        { 0, 5, 1, 1, 1 },
+        { 1, 5, 0, 2, 2 },
+        { 2, 5, 2, 3, 1 },
+        { 0, 5, 1, 4, 1 }
+    };
+    ReducedTable reduced(t);
+    BOOST_CHECK_EQUAL( reduced.table.size(), 4 );
+    BOOST_CHECK_EQUAL( reduced.table[0].size(), 3 );
+    BOOST_CHECK_EQUAL( sorted(getGenerators(reduced)), mineDirectly(t) );
+    // only constant & unique columns left
+    Table trivial = { { 1, 0 }, { 1, 1 }, { 1, 1 } };
+    BOOST_CHECK_EQUAL( sorted(getGenerators(ReducedTable(trivial))), mineDirectly(trivial) );
+}
+
+BOOST_AUTO_TEST_CASE( test_ReducedTable_random )
+{
+    srand(42);
+    for ( int test = 0; test < 50; test++ )
+    {
+        Table t(5 + rand() % 20, Row(6));
+        for ( size_t row = 0; row < t.size(); row++ )
+            for ( size_t col = 0; col < 6; col++ )
+                t[row][col] = col == 5 ? row : rand() % (col + 1);
+        BOOST_CHECK_EQUAL( sorted(getGenerators(ReducedTable(t))), mineDirectly(t) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_shards )
+{
+    srand(7);
+    for ( int test = 0; test < 20; test++ )
+    {
+        Table t(5 + rand() % 20, Row(6));
+        for ( size_t row = 0; row < t.size(); row++ )
+            for ( size_t col = 0; col < 6; col++ )
+                t[row][col] = col == 5 ? row : rand() % (col + 1);
+        for ( MinerOptions::Engine engine : { MinerOptions::Engine::Closure, MinerOptions::Engine::Pairs } )
+        {
+            MinerOptions options;
+            options.engine = engine;
+            options.shardCount = 3;
+            set<AttributeSet> merged;
+            for ( options.shard = 0; options.shard < options.shardCount; options.shard++ )
+                for ( const AttributeSet &gen : getGenerators(ReducedTable(t), options) )
+                    merged.insert(gen);
+            BOOST_CHECK_EQUAL( vector<AttributeSet>(merged.begin(), merged.end()), mineDirectly(t) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_visitGenerators )
+{
+    srand(11);
+    for ( int test = 0; test < 20; test++ )
+    {
+        Table t(5 + rand() % 20, Row(6));
+        for ( size_t row = 0; row < t.size(); row++ )
+            for ( size_t col = 0; col < 6; col++ )
+                t[row][col] = col == 5 ? row : rand() % (col + 1);
+        // each generator is passed on exactly once
+        vector<AttributeSet> visited;
+        visitGenerators(ReducedTable(t), MinerOptions(), [&visited](const AttributeSet &gen) { visited.push_back(gen); });
+        BOOST_CHECK_EQUAL( sorted(visited), mineDirectly(t) );
+    }
+}
+
+//----------------- sampling --------------------
+
+BOOST_AUTO_TEST_CASE( test_sampleAgreeSets )
+{
+    vector<AttributeSet> sampled = sampleAgreeSets(table);
+    // sampled sets must be actual agree sets
+    for ( const AttributeSet &ag : sampled )
+        BOOST_CHECK_EQUAL( closure(ag), ag );
+    srand(7);
+    for ( int test = 0; test < 20; test++ )
+    {
+        Table t(50, Row(8));
+        for ( Row &row : t )
+            for ( size_t col = 0; col < row.size(); col++ )
+                row[col] = rand() % (col + 2);
+        ClosureCalculator plain(t), seeded(t);
+        MinerOptions options;
+        options.sampleWindow = 2;
+        BOOST_CHECK_EQUAL( sorted(getGenerators(seeded, options)), sorted(getGenerators(plain)) );
+        BOOST_CHECK( seeded.passes() <= plain.passes() );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_sharedTraversal )
+{
+    MinerOptions options;
+    options.sharedTraversal = true;
+    ClosureCalculator shared(table);
+    BOOST_CHECK_EQUAL( sorted(getGenerators(shared, options)), sorted(getGenerators(closure)) );
+    srand(13);
+    for ( int test = 0; test < 20; test++ )
+    {
+        Table t(40, Row(9));
+        for ( Row &row : t )
+            for ( size_t col = 0; col < row.size(); col++ )
+                row[col] = rand() % (2 + col % 3);
+        ClosureCalculator plainClosure(t), sharedClosure(t), mmcsClosure(t);
+        const vector<AttributeSet> expected = sorted(getGenerators(plainClosure));
+        BOOST_CHECK_EQUAL( sorted(getGenerators(sharedClosure, options)), expected );
+        options.transversals = MinerOptions::Transversals::MMCS;
+        BOOST_CHECK_EQUAL( sorted(getGenerators(mmcsClosure, options)), expected );
+        options.transversals = MinerOptions::Transversals::Berge;
+    }
+}
+
+//----------------- pair engine -----------------
+
+BOOST_AUTO_TEST_CASE( test_getMaximalClasses )
+{
+    // classes of column 0 and 1 are contained in class of column 3, column 2 has none
+    vector<vector<RowID>> classes = getMaximalClasses(table);
+    BOOST_CHECK_EQUAL( classes, vector<vector<RowID>>({ { 0, 1, 2, 3 } }) );
+    BOOST_CHECK_EQUAL( countClassPairs(classes), 6 );
+}
+
+BOOST_AUTO_TEST_CASE( test_getPairGenerators )
+{
+    MinerOptions options;
+    options.engine = MinerOptions::Engine::Pairs;
+    BOOST_CHECK_EQUAL( sorted(getGenerators(table, options)), sorted(getGenerators(closure)) );
+    // rows 0 and 2 agree on no column
+    Table disjoint = { { 0, 0, 0 }, { 0, 1, 1 }, { 1, 1, 2 } };
+    BOOST_CHECK_EQUAL( sorted(getGenerators(disjoint, options)), mineDirectly(disjoint) );
+    srand(11);
+    for ( int test = 0; test < 30; test++ )
+    {
+        Table t(20 + rand() % 20, Row(12));
+        for ( Row &row : t )
+            for ( size_t col = 0; col < row.size(); col++ )
+                row[col] = rand() % (2 + col * test / 4);
+        BOOST_CHECK_EQUAL( sorted(getGenerators(t, options)), mineDirectly(t) );
+    }
+}
+
+//----------------- transversals ----------------
+
+static vector<AttributeSet> enumerate(HittingSetEngine &engine)
+{
+    vector<AttributeSet> result;
+    engine.run([&result](const AttributeSet &t) { result.push_back(t); });
+    return sorted(result);
+}
+
+BOOST_AUTO_TEST_CASE( test_HittingSetEngine )
+{
+    BergeHittingSets berge(4);
+    MMCSHittingSets mmcs(4);
+    for ( HittingSetEngine *engine : { (HittingSetEngine*)&berge, (HittingSetEngine*)&mmcs } )
+    {
+        engine->addEdge(AS(0011));
+        engine->addEdge(AS(0110));
+        engine->addEdge(AS(1100));
+    }
+    vector<AttributeSet> expected = { AS(0101), AS(0110), AS(1010) };
+    BOOST_CHECK_EQUAL( enumerate(berge), expected );
+    BOOST_CHECK_EQUAL( enumerate(mmcs), expected );
+    // edges added during enumeration
+    srand(5);
+    for ( int test = 0; test < 30; test++ )
+    {
+        Table t(30, Row(10));
+        for ( Row &row : t )
+            for ( size_t col = 0; col < row.size(); col++ )
+                row[col] = rand() % (2 + col % 4);
+        ClosureCalculator bergeClosure(t), mmcsClosure(t);
+        MinerOptions options;
+        options.transversals = MinerOptions::Transversals::MMCS;
+        BOOST_CHECK_EQUAL( sorted(getGenerators(mmcsClosure, options)), sorted(getGenerators(bergeClosure)) );
+    }
+}
+
+//----------------- incremental -----------------
+
+BOOST_AUTO_TEST_CASE( test_updateGenerators )
+{
+    srand(17);
+    const string fileName = "testASM.state";
+    for ( int test = 0; test < 30; test++ )
+    {
+        Table t(10 + rand() % 30, Row(7));
+        for ( Row &row : t )
+            for ( size_t col = 0; col < row.size(); col++ )
+                row[col] = rand() % (1 + col * test / 6);
+        // grow table in batches of varying size, re-opening state for each, so that runs get merged and compacted
+        MinerState::create(fileName, Table(), vector<AttributeSet>());
+        for ( size_t next = 0; next < t.size(); )
+        {
+            size_t batch = min<size_t>(1 + rand() % 10, t.size() - next);
+            MinerState state(fileName);
+            state.append(Table(t.begin() + next, t.begin() + next + batch));
+            next += batch;
+            BOOST_CHECK_EQUAL( state.getTable(), Table(t.begin(), t.begin() + next) );
+            BOOST_CHECK_EQUAL( sorted(state.getGenerators()), mineDirectly(state.getTable()) );
+        }
+    }
+    MinerState::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE( test_MinerState )
+{
+    const string fileName = "testASM.state";
+    MinerState::create(fileName, table, mineDirectly(table));
+    {
+        MinerState loaded(fileName);
+        BOOST_CHECK_EQUAL( loaded.rows(), table.size() );
+        BOOST_CHECK_EQUAL( loaded.getTable(), table );
+        BOOST_CHECK_EQUAL( loaded.getGenerators(), mineDirectly(table) );
+        BOOST_CHECK_THROW( loaded.append(Table(1, Row(3))), runtime_error );
+    }
+    // failed append must leave state intact
+    MinerState reloaded(fileName);
+    BOOST_CHECK_EQUAL( reloaded.getTable(), table );
+    MinerState::remove(fileName);
+    BOOST_CHECK_THROW( MinerState loaded(fileName), runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( test_ColumnTable )
+{
+    Table t = {
+        { 0, 1, 2 },
+        { 0, 1, 3 },
+        { 1, 1, 3 },
+        { 1, 2, 2 },
+        { 2, 2, 4 }
+    };
+    // written in two batches, the second one too small for any column to be written in one go
+    const string fileName = "testASM.cols";
+    ColumnFileWriter writer(fileName, t.size(), t[0].size());
+    writer.append(Table(t.begin(), t.begin() + 3));
+    BOOST_CHECK_THROW( writer.close(), runtime_error );
+    writer.append(Table(t.begin() + 3, t.end()));
+    writer.close();
+    ColumnTable mapped = ColumnTable::map(fileName);
+    remove(fileName.c_str());
+    const ColumnTable copied(t);
+    BOOST_REQUIRE_EQUAL( mapped.rows(), t.size() );
+    BOOST_REQUIRE_EQUAL( mapped.columns(), t[0].size() );
+    for ( size_t col = 0; col < t[0].size(); col++ )
+        for ( size_t row = 0; row < t.size(); row++ )
+        {
+            BOOST_CHECK_EQUAL( mapped.column(col)[row], t[row][col] );
+            BOOST_CHECK_EQUAL( copied.column(col)[row], t[row][col] );
+        }
+    BOOST_CHECK_EQUAL( sorted(getGenerators(mapped, MinerOptions())), mineDirectly(t) );
+    BOOST_CHECK_THROW( ColumnTable::map(fileName), runtime_error );
+}
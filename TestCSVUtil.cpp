@@ -0,0 +1,72 @@
+#define BOOST_TEST_MODULE TestCSVUtil
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+#include "VectorUtil.h"
+#include "CSVUtil.h"
+
+using namespace std;
+
+static Table parse(const string &data, unsigned chunks = 1)
+{
+    Table t;
+    parse_csv(t, data.data(), data.size(), chunks);
+    return t;
+}
+
+BOOST_AUTO_TEST_CASE( test_parse_csv )
+{
+    Table t = parse("a,b,\"a\"\r\n\nb,\"a,b\",a\\,b\n\"x\ny\",x\\ny,\n");
+    BOOST_REQUIRE_EQUAL( t.size(), 3 );
+    BOOST_CHECK_EQUAL( t[0].size(), 3 );
+    BOOST_CHECK_EQUAL( t[1].size(), 3 );
+    BOOST_CHECK_EQUAL( t[2].size(), 3 );
+    // quoting and escaping do not change cell content
+    BOOST_CHECK_EQUAL( t[0][0], t[0][2] );
+    BOOST_CHECK_EQUAL( t[0][1], t[1][0] );
+    BOOST_CHECK_EQUAL( t[1][1], t[1][2] );
+    BOOST_CHECK_EQUAL( t[2][0], t[2][1] );
+    BOOST_CHECK( t[0][0] != t[0][1] );
+    BOOST_CHECK( t[2][2] != t[0][0] );
+}
+
+BOOST_AUTO_TEST_CASE( test_read_csv )
+{
+    istringstream in("1,2\n3,4");
+    Table t;
+    read_csv(t, in);
+    BOOST_CHECK_EQUAL( t, parse("1,2\n3,4\n") );
+    BOOST_CHECK_THROW( parse("1,\\x\n"), runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( test_parse_csv_chunks )
+{
+    // quoted line breaks and escapes should end up on all sides of chunk boundaries
+    ostringstream data;
+    for ( int row = 0; row < 200; row++ )
+        data << row % 7 << ",\"" << row % 3 << "\n,\\\"" << "\",x\\\\" << row % 5 << "\n";
+    Table expected = parse(data.str());
+    BOOST_CHECK_EQUAL( expected.size(), 200 );
+    for ( unsigned chunks = 2; chunks < 40; chunks += 3 )
+        BOOST_CHECK_EQUAL( parse(data.str(), chunks), expected );
+}
+
+BOOST_AUTO_TEST_CASE( test_parse_csv_batches )
+{
+    ostringstream data;
+    for ( int row = 0; row < 100; row++ )
+        data << row % 7 << ",\"" << row % 3 << "\n,\\\"" << "\",x\\\\" << row % 5 << "\n";
+    const string s = data.str();
+    Table expected = parse(s);
+    for ( size_t chunkBytes : { 1, 7, 64, 1000, 100000 } )
+    {
+        Table t;
+        size_t batches = 0;
+        parse_csv_chunks(s.data(), s.size(), chunkBytes, [&](Table &batch) {
+            batches++;
+            t.insert(t.end(), batch.begin(), batch.end());
+        });
+        BOOST_CHECK_EQUAL( t, expected );
+        BOOST_CHECK( batches > 1 || chunkBytes >= s.size() );
+    }
+}
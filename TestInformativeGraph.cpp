@@ -1,8 +1,11 @@
 #define BOOST_TEST_MODULE TestInformativeGraph
 #include <boost/test/unit_test.hpp>
+#include <set>
 
 #include "VectorUtil.h"
 #include "DominanceGraph.h"
+#include "EdgeFile.h"
+#include "InformativeGreedy.h"
 #include "BoostTestNoLog.h" // disable logging during test
 
 using namespace std;
@@ -33,6 +36,23 @@ BOOST_AUTO_TEST_CASE( test_getNeighbors )
     }
 }
 
+BOOST_AUTO_TEST_CASE( test_neighbors )
+{
+    // star with removals from middle and end of neighbor list
+    InformativeGraph g;
+    for ( NodeID leaf = 1; leaf <= 5; leaf++ )
+        g.addEdge(0, leaf, leaf);
+    g.removeNode(2);
+    g.removeNode(5);
+    span<const NodeID> n = g.neighbors(0);
+    BOOST_CHECK_EQUAL(sorted(vector<NodeID>(n.begin(), n.end())), vector<NodeID>({1, 3, 4}));
+    BOOST_CHECK_EQUAL(g.degree(0), 3);
+    BOOST_CHECK(g.neighbors(2).empty());
+    g.removeNode(0);
+    for ( NodeID leaf = 1; leaf <= 5; leaf++ )
+        BOOST_CHECK(g.neighbors(leaf).empty());
+}
+
 BOOST_AUTO_TEST_CASE( test_getForced )
 {
     InformativeGraph g = toGraph();
@@ -40,6 +60,24 @@ BOOST_AUTO_TEST_CASE( test_getForced )
     // check again after removing node
     g.removeNode(0);
     BOOST_CHECK_EQUAL(sorted(g.getForced()), vector<NodeID>({2, 3, 4, 5}));
+    // labels 1 and 2 have no edges, and must not be mistaken for live labels
+    InformativeGraph gaps;
+    gaps.addEdge(4, 5, 0);
+    gaps.addEdge(5, 6, 0);
+    gaps.addEdge(0, 1, 3);
+    gaps.removeNode(0);
+    BOOST_CHECK_EQUAL(gaps.getForced(), vector<NodeID>({5}));
+}
+
+BOOST_AUTO_TEST_CASE( test_getNewlyForced )
+{
+    InformativeGraph g = toGraph();
+    BOOST_CHECK_EQUAL(g.getNewlyForced(), vector<NodeID>({2, 4, 5}));
+    BOOST_CHECK(g.getNewlyForced().empty());
+    // only label 0 changed
+    g.removeNode(0);
+    BOOST_CHECK_EQUAL(g.getNewlyForced(), vector<NodeID>({3, 4}));
+    BOOST_CHECK(g.getNewlyForced().empty());
 }
 
 BOOST_AUTO_TEST_CASE( test_pickNode )
@@ -56,6 +94,20 @@ BOOST_AUTO_TEST_CASE( test_pickNode )
     BOOST_CHECK_EQUAL(updated, expected);
 }
 
+BOOST_AUTO_TEST_CASE( test_pickNode_removed )
+{
+    // edges removed before their label is certain are skipped
+    InformativeGraph g = toGraph();
+    std::unordered_set<NodeID> updated;
+    g.removeNode(0);
+    g.pickNode(4, &updated);
+    g.pickNode(3, &updated);
+    BOOST_CHECK_EQUAL(updated, std::unordered_set<NodeID>({3, 4}));
+    BOOST_CHECK_EQUAL(g.degree(1), 1);
+    BOOST_CHECK_EQUAL(g.degree(3), 1);
+    BOOST_CHECK_EQUAL(sorted(g.getForced()), vector<NodeID>({2, 4, 5}));
+}
+
 BOOST_AUTO_TEST_CASE( test_getCertainAgreeSets )
 {
     InformativeGraph g = toGraph();
@@ -79,6 +131,24 @@ BOOST_AUTO_TEST_CASE( test_getPossibleAgreeSets )
     BOOST_CHECK_EQUAL(g.getPossibleAgreeSets(3), vector<NodeID>({0}));
 }
 
+BOOST_AUTO_TEST_CASE( test_getAgreeSetCount )
+{
+    InformativeGraph g = toGraph();
+    BOOST_CHECK_EQUAL(g.getPossibleAgreeSetCount(3), 2);
+    BOOST_CHECK_EQUAL(g.getCertainAgreeSetCount(3), 0);
+    g.pickNode(2);
+    BOOST_CHECK_EQUAL(g.getCertainAgreeSetCount(3), 1);
+    g.removeNode(4);
+    BOOST_CHECK_EQUAL(g.getPossibleAgreeSetCount(3), 1);
+    BOOST_CHECK_EQUAL(g.getPossibleAgreeSetCount(5), 0);
+    // adding edges after picking rebuilds counts
+    g.addEdge(3, 5, 2);
+    BOOST_CHECK_EQUAL(g.getPossibleAgreeSets(3), vector<NodeID>({1, 2}));
+    BOOST_CHECK_EQUAL(g.getCertainAgreeSetCount(3), 1);
+    g.pickNode(5);
+    BOOST_CHECK_EQUAL(g.getCertainAgreeSets(3), vector<NodeID>({1, 2}));
+}
+
 //----------------- DominanceGraph --------------
 
 BOOST_AUTO_TEST_CASE( test_isDominated )
@@ -125,3 +195,50 @@ BOOST_AUTO_TEST_CASE( test_prune )
     BOOST_CHECK_EQUAL(picked, expected);
     BOOST_CHECK(g.degree(1) == 0);
 }
+
+BOOST_AUTO_TEST_CASE( test_EdgeFile )
+{
+    // large gaps need multi-byte varints
+    vector<vector<NodeID>> sortedEdges = edges;
+    sortedEdges.push_back({ 5, 1000, 3 });
+    sortedEdges.push_back({ 5, 70000, 1 });
+    sortedEdges.push_back({ 300, 4000000, 300 });
+    const string fileName = "testIG.edges";
+    for ( bool delta : { false, true } )
+    {
+        EdgeFileWriter writer(fileName, delta);
+        for ( const vector<NodeID> &edge : sortedEdges )
+            writer.add(edge[0], edge[1], edge[2]);
+        writer.close();
+        EdgeFileReader reader(fileName);
+        BOOST_CHECK_EQUAL( reader.getHeader().delta, delta );
+        BOOST_CHECK_EQUAL( reader.getHeader().nodeCount, 4000001 );
+        BOOST_CHECK_EQUAL( reader.getHeader().labelCount, 301 );
+        BOOST_CHECK_EQUAL( reader.getHeader().edgeCount, sortedEdges.size() );
+        vector<vector<NodeID>> read;
+        reader.visit([&read](NodeID v, NodeID w, AgreeSetID ag) { read.push_back({ v, w, ag }); });
+        BOOST_CHECK( read == sortedEdges );
+    }
+    EdgeFileWriter writer(fileName, true);
+    writer.add(2, 3, 0);
+    BOOST_CHECK_THROW( writer.add(1, 3, 0), runtime_error );
+    remove(fileName.c_str());
+    BOOST_CHECK_THROW( EdgeFileReader reader(fileName), runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( test_pickGreedy )
+{
+    InformativeGraph g = toGraph();
+    for ( bool pruning : { false, true } )
+    {
+        vector<NodeID> picked = pickGreedy(g, pruning);
+        // every label must occur on an edge between picked nodes
+        set<AgreeSetID> labels;
+        for ( NodeID v : picked )
+            for ( NodeID w : picked )
+                if ( v < w && contains(g.getNeighbors(v), w) )
+                    labels.insert(g.getEdgeLabel(v, w));
+        BOOST_CHECK_EQUAL( labels.size(), 3 );
+        BOOST_CHECK_EQUAL( picked.size(), 4 );
+    }
+}
@@ -2,7 +2,11 @@
 #include <boost/test/unit_test.hpp>
 #include <algorithm>
 
+#include <boost/mpl/list.hpp>
+
 #include "OrderedTrie.h"
+#include "SignatureIndex.h"
+#include "AttributeSetTrie.h"
 #include "VectorUtil.h"
 #include "BoostTestNoLog.h" // disable logging during test
 
@@ -17,10 +21,13 @@ const vector<vector<int>> trieSets = {
     { 2, 4 }
 };
 
-BOOST_AUTO_TEST_CASE( test_findSubsets )
+// interchangeable subset/superset indices
+typedef boost::mpl::list<OrderedTrie<int,int>, SignatureIndex<int,int>> SetIndexTypes;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_findSubsets, SetIndex, SetIndexTypes )
 {
     vector<int> superSet = { 1, 2, 4 };
-    OrderedTrie<int,int> trie;
+    SetIndex trie;
     for ( size_t id = 0; id < trieSets.size(); id++ )
         trie.insert(id, trieSets[id]);
     vector<int> subSets = trie.findSubsets(superSet);
@@ -29,10 +36,10 @@ BOOST_AUTO_TEST_CASE( test_findSubsets )
     BOOST_CHECK_EQUAL( subSets, expected );
 }
 
-BOOST_AUTO_TEST_CASE( test_findSupersets )
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_findSupersets, SetIndex, SetIndexTypes )
 {
     vector<int> subSet = { 2, 4 };
-    OrderedTrie<int,int> trie;
+    SetIndex trie;
     for ( size_t id = 0; id < trieSets.size(); id++ )
         trie.insert(id, trieSets[id]);
     vector<int> superSets = trie.findSupersets(subSet);
@@ -40,3 +47,132 @@ BOOST_AUTO_TEST_CASE( test_findSupersets )
     vector<int> expected = { 0, 5 };
     BOOST_CHECK_EQUAL( superSets, expected );
 }
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_hasSuperset, SetIndex, SetIndexTypes )
+{
+    SetIndex trie;
+    for ( size_t id = 0; id < trieSets.size(); id++ )
+        trie.insert(id, trieSets[id]);
+    BOOST_CHECK( trie.hasSuperset({ 2, 4 }, 0) );
+    BOOST_CHECK( !trie.hasSuperset({ 1, 2, 5 }, 1) );
+    BOOST_CHECK( trie.hasSuperset({ 1, 2, 5 }, 0) );
+    BOOST_CHECK( !trie.hasSuperset({ 3, 4 }, 0) );
+    BOOST_CHECK( trie.hasSubset({ 1, 2, 4 }, 2) );
+    BOOST_CHECK( !trie.hasSubset({ 1, 4 }, 2) );
+    BOOST_CHECK( !trie.hasSubset({ 1, 5 }, 0) );
+    // visiting stops at first match
+    size_t visited = 0;
+    BOOST_CHECK( !trie.visitSupersets({ 2 }, [&visited](int) { visited++; return false; }) );
+    BOOST_CHECK_EQUAL( visited, 1 );
+    BOOST_CHECK( trie.visitSubsets({ 1, 2, 4 }, [&visited](int) { visited++; return true; }) );
+    BOOST_CHECK_EQUAL( visited, 5 );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_bulkLoad, SetIndex, SetIndexTypes )
+{
+    vector<pair<int,vector<int>>> entries;
+    for ( size_t id = 0; id < trieSets.size(); id++ )
+        entries.push_back(make_pair(id, trieSets[id]));
+    // order of entries must not matter
+    reverse(entries.begin(), entries.end());
+    SetIndex trie(entries);
+    for ( size_t id = 0; id < trieSets.size(); id++ )
+        BOOST_CHECK_EQUAL( trie.at(id), trieSets[id] );
+    vector<int> superSets = trie.findSupersets({ 2, 4 });
+    sort(superSets.begin(), superSets.end());
+    BOOST_CHECK_EQUAL( superSets, vector<int>({ 0, 5 }) );
+    // ids of equal sets are found in the order given, as if inserted one at a time
+    vector<pair<int,vector<int>>> equalEntries;
+    vector<int> order;
+    for ( int id = 0; id < 40; id++ )
+    {
+        order.push_back(id * 7 % 40);
+        equalEntries.push_back(make_pair(order.back(), vector<int>({ 1, 2 })));
+    }
+    SetIndex equal(equalEntries);
+    BOOST_CHECK_EQUAL( equal.findSupersets({ 1 }), order );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_update, SetIndex, SetIndexTypes )
+{
+    SetIndex trie;
+    for ( size_t id = 0; id < trieSets.size(); id++ )
+        trie.insert(id, trieSets[id]);
+    BOOST_CHECK( !trie.insert(0, { 1, 2, 4 }) );
+    BOOST_CHECK( trie.insert(0, { 2, 3 }) );
+    BOOST_CHECK_EQUAL( trie.at(0), vector<int>({ 2, 3 }) );
+    // prefixes and extensions of stored set are changes
+    BOOST_CHECK( trie.insert(0, { 2, 3, 4 }) );
+    BOOST_CHECK( trie.insert(0, { 3 }) );
+    BOOST_CHECK( !trie.insert(0, { 3 }) );
+    BOOST_CHECK( trie.insert(0, { 2, 3 }) );
+    BOOST_CHECK( trie.erase(4) );
+    BOOST_CHECK( !trie.erase(4) );
+    BOOST_CHECK( !trie.contains(4) );
+    // many updates trigger re-layout of nodes
+    for ( int round = 0; round < 20; round++ )
+        for ( size_t id = 0; id < trieSets.size(); id++ )
+            trie.insert(id, trieSets[(id + round) % trieSets.size()]);
+    for ( size_t id = 0; id < trieSets.size(); id++ )
+        BOOST_CHECK_EQUAL( trie.at(id), trieSets[(id + 19) % trieSets.size()] );
+    vector<int> subSets = trie.findSubsets({ 1, 2, 4 });
+    sort(subSets.begin(), subSets.end());
+    // sets 0, 2, 3, 5 are now stored under ids 5, 1, 2, 4
+    BOOST_CHECK_EQUAL( subSets, vector<int>({ 1, 2, 4, 5 }) );
+}
+
+BOOST_AUTO_TEST_CASE( test_visitOrder )
+{
+    // SignatureIndex visits ids in the same order as OrderedTrie, through bulk-loading, updates and erasures
+    srand(11);
+    vector<pair<int,vector<int>>> entries;
+    for ( int id = 0; id < 30; id++ )
+        entries.push_back(make_pair(id, trieSets[rand() % trieSets.size()]));
+    OrderedTrie<int,int> trie(entries);
+    SignatureIndex<int,int> signatures(entries);
+    for ( int step = 0; step < 300; step++ )
+    {
+        const int id = rand() % 40;
+        if ( rand() % 3 == 0 )
+            BOOST_CHECK_EQUAL( trie.erase(id), signatures.erase(id) );
+        else
+        {
+            const vector<int> &value = trieSets[rand() % trieSets.size()];
+            BOOST_CHECK_EQUAL( trie.insert(id, value), signatures.insert(id, value) );
+        }
+        for ( const vector<int> &s : { vector<int>({ 1, 2, 4 }), vector<int>({ 2 }), vector<int>({ 1, 2, 3, 4, 5 }), vector<int>() } )
+        {
+            BOOST_CHECK_EQUAL( trie.findSubsets(s), signatures.findSubsets(s) );
+            BOOST_CHECK_EQUAL( trie.findSupersets(s), signatures.findSupersets(s) );
+        }
+    }
+}
+
+//----------------- AttributeSetTrie ------------
+
+#define AS(x) AttributeSet(string(#x))
+
+BOOST_AUTO_TEST_CASE( test_AttributeSetTrie )
+{
+    AttributeSetTrie trie;
+    BOOST_CHECK( trie.insert(AS(0110)) );
+    BOOST_CHECK( trie.insert(AS(1001)) );
+    BOOST_CHECK( trie.insert(AS(1101)) );
+    BOOST_CHECK( !trie.insert(AS(0110)) );
+    BOOST_CHECK_EQUAL( trie.size(), 3 );
+    BOOST_CHECK( trie.contains(AS(1001)) );
+    BOOST_CHECK( !trie.contains(AS(1000)) );
+    BOOST_CHECK( trie.containsSubset(AS(0111)) );
+    BOOST_CHECK( trie.containsSubset(AS(1101)) );
+    BOOST_CHECK( !trie.containsSubset(AS(0101)) );
+    BOOST_CHECK( trie.containsStrictSubset(AS(1101)) );
+    BOOST_CHECK( !trie.containsStrictSubset(AS(0110)) );
+    BOOST_CHECK( trie.erase(AS(1001)) );
+    BOOST_CHECK( !trie.erase(AS(1001)) );
+    BOOST_CHECK( !trie.containsStrictSubset(AS(1101)) );
+    BOOST_CHECK( trie.containsSubset(AS(1101)) );
+    BOOST_CHECK( trie.erase(AS(1101)) );
+    BOOST_CHECK( !trie.containsSubset(AS(1111) ^ AS(0010)) );
+    BOOST_CHECK( trie.insert(AttributeSet(4)) );
+    BOOST_CHECK( trie.containsSubset(AS(0000)) );
+}
@@ -0,0 +1,9 @@
+# compares transversal enumeration of the closure engine on all data sets
+for f in *.csv
+do
+    for t in berge mmcs
+    do
+        echo "$f ($t)"
+        ( time ../miner -e closure -t $t $f > /dev/null ) 2>&1 | grep real
+    done
+done
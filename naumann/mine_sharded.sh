@@ -0,0 +1,15 @@
+#!/bin/bash
+# mines generators of one data set using several local miner processes, then merges their results
+# usage: mine_sharded.sh file.csv shards [miner options]
+# each shard writes file.shard-i-of-n.txt and can be rerun on its own, e.g. by a batch scheduler
+f=$1
+n=$2
+shift 2
+base=${f%.csv}
+for (( i = 0; i < n; i++ ))
+do
+    out=$base.shard-$i-of-$n.txt
+    ( ../miner --shard $i/$n "$@" $f > $out.tmp && mv $out.tmp $out ) &
+done
+wait
+../miner --merge $base.shard-*-of-$n.txt > $base.txt
@@ -0,0 +1,3 @@
+# mines generators, extracts edges and picks informative rows for all data sets in one process per data set
+# usage: pipeline_all.sh [jobs]
+../pipeline -j ${1:-1} .